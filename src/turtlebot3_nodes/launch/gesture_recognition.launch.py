@@ -1,8 +1,10 @@
 from ament_index_python.packages import get_package_share_directory
 from launch_ros.actions import Node
 from launch import LaunchDescription
+from launch.conditions import IfCondition, UnlessCondition
 from launch.launch_description_sources import PythonLaunchDescriptionSource
-from launch.actions import IncludeLaunchDescription 
+from launch.actions import DeclareLaunchArgument, IncludeLaunchDescription
+from launch.substitutions import LaunchConfiguration
 import os
 
 def generate_launch_description():
@@ -10,22 +12,34 @@ def generate_launch_description():
                         'turtlebot3_gazebo'),
                         'launch',
                         'empty_world.launch.py') 
+    # composed:=true runs recognition and the cmd_vel ramp in one process
+    composed = LaunchConfiguration('composed')
     gesture_recognition = Node(
         package = 'turtlebot3_nodes',
         executable = 'turtlebot3_gesture_publisher',
         name = 'turtlebot3_gesture_publisher',
-        output = 'screen'
+        output = 'screen',
+        condition = UnlessCondition(composed)
     )
     cmd_vel = Node(
         package = 'turtlebot3_nodes',
         executable= 'turtlebot3_cmd_vel',
         name = 'turtlebot3_cmd_vel',
-        output = 'screen'
+        output = 'screen',
+        condition = UnlessCondition(composed)
+    )
+    gesture_teleop = Node(
+        package = 'turtlebot3_nodes',
+        executable = 'turtlebot3_gesture_teleop',
+        output = 'screen',
+        condition = IfCondition(composed)
     )
     return LaunchDescription([
+        DeclareLaunchArgument('composed', default_value='false'),
         IncludeLaunchDescription(
             PythonLaunchDescriptionSource(gazebo_sim_path)
         ),
         gesture_recognition,
-        cmd_vel
-    ])
\ No newline at end of file
+        cmd_vel,
+        gesture_teleop
+    ])
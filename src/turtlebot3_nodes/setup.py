@@ -1,4 +1,4 @@
-from setuptools import find_packages, setup
+from setuptools import Extension, find_packages, setup
 import os
 from glob import glob
 
@@ -18,6 +18,24 @@ for file in required_model_files:
     if not os.path.exists(file):
         raise RuntimeError(f"Critical model file missing: {file}")
 
+# Native keypoint classifier engine. It is built for the portable baseline
+# of the architecture and picks AVX at runtime, so the binary can be copied
+# between machines. Set TURTLEBOT3_NATIVE_ARCH=1 to tune for the build host
+# instead. The extension is optional: without a compiler or Python headers
+# the classifier falls back to numpy.
+engine_compile_args = ['-std=c++17', '-O3']
+if os.environ.get('TURTLEBOT3_NATIVE_ARCH') == '1':
+    engine_compile_args.append('-march=native')
+keypoint_engine = Extension(
+    package_name + '._keypoint_engine',
+    sources=['src/keypoint_engine.cpp', 'src/keypoint_engine_module.cpp'],
+    depends=['src/keypoint_engine.hpp'],
+    include_dirs=['src'],
+    language='c++',
+    extra_compile_args=engine_compile_args,
+    optional=True,
+)
+
 setup(
     name=package_name,
     version='0.0.0',
@@ -32,6 +50,7 @@ setup(
         (os.path.join('share', package_name, 'launch'), 
             launch_files),
     ],
+    ext_modules=[keypoint_engine],
     install_requires=[
         'setuptools',
         'rclpy',
@@ -40,7 +59,7 @@ setup(
         'tensorflow',
         'numpy'
     ],
-    zip_safe=True,
+    zip_safe=False,
     maintainer='madiyar',
     maintainer_email='madiyar@todo.todo',
     description='Gesture recognition and control for TurtleBot3',
@@ -50,6 +69,12 @@ setup(
         'console_scripts': [
             'turtlebot3_gesture_publisher = turtlebot3_nodes.turtlebot3_gesture_publisher:main',
             'turtlebot3_cmd_vel = turtlebot3_nodes.turtlebot3_cmd_vel:main',
+            'turtlebot3_gesture_teleop = turtlebot3_nodes.turtlebot3_gesture_teleop:main',
+            'turtlebot3_fleet_sim = turtlebot3_nodes.turtlebot3_fleet_sim:main',
+            'cmd_vel_benchmark = turtlebot3_nodes.cmd_vel_benchmark:main',
+            'gesture_replay = turtlebot3_nodes.gesture_replay:main',
+            'keypoint_classifier_benchmark = '
+            'turtlebot3_nodes.keypoint_classifier_benchmark:main',
         ],
     },
 )
\ No newline at end of file
@@ -0,0 +1,274 @@
+#include "keypoint_engine.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+#include <immintrin.h>
+#define KEYPOINT_ENGINE_X86 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace turtlebot3_nodes
+{
+
+namespace
+{
+
+// Every output row is padded to a multiple of kPad floats, which covers the
+// widest vector below so one packed layout serves all kernels.
+constexpr int kPad = 8;
+// Accumulators kept live across the input loop of one column tile.
+constexpr int kTileVectors = 4;
+
+// Vector operations of each kernel. The baseline is what every CPU of the
+// target architecture has (SSE2 on x86-64, NEON on aarch64), so a binary
+// built on one machine runs on any robot; AVX/FMA is only used after a
+// runtime CPU check.
+#if defined(KEYPOINT_ENGINE_X86)
+#define KEYPOINT_ENGINE_TARGET_AVX __attribute__((target("avx,fma")))
+
+struct AvxOps
+{
+  using Vec = __m256;
+  static constexpr int kLanes = 8;
+  static constexpr const char * kName = "avx";
+  KEYPOINT_ENGINE_TARGET_AVX static Vec load(const float * p) {return _mm256_loadu_ps(p);}
+  KEYPOINT_ENGINE_TARGET_AVX static void store(float * p, Vec v) {_mm256_storeu_ps(p, v);}
+  KEYPOINT_ENGINE_TARGET_AVX static Vec set1(float x) {return _mm256_set1_ps(x);}
+  KEYPOINT_ENGINE_TARGET_AVX static Vec max0(Vec v)
+  {
+    return _mm256_max_ps(v, _mm256_setzero_ps());
+  }
+  KEYPOINT_ENGINE_TARGET_AVX static Vec fmadd(Vec a, Vec b, Vec c)
+  {
+    return _mm256_fmadd_ps(a, b, c);
+  }
+};
+
+struct BaselineOps
+{
+  using Vec = __m128;
+  static constexpr int kLanes = 4;
+  static constexpr const char * kName = "sse2";
+  static Vec load(const float * p) {return _mm_loadu_ps(p);}
+  static void store(float * p, Vec v) {_mm_storeu_ps(p, v);}
+  static Vec set1(float x) {return _mm_set1_ps(x);}
+  static Vec max0(Vec v) {return _mm_max_ps(v, _mm_setzero_ps());}
+  static Vec fmadd(Vec a, Vec b, Vec c) {return _mm_add_ps(_mm_mul_ps(a, b), c);}
+};
+#elif defined(__ARM_NEON)
+struct BaselineOps
+{
+  using Vec = float32x4_t;
+  static constexpr int kLanes = 4;
+  static constexpr const char * kName = "neon";
+  static Vec load(const float * p) {return vld1q_f32(p);}
+  static void store(float * p, Vec v) {vst1q_f32(p, v);}
+  static Vec set1(float x) {return vdupq_n_f32(x);}
+  static Vec max0(Vec v) {return vmaxq_f32(v, vdupq_n_f32(0.0f));}
+  static Vec fmadd(Vec a, Vec b, Vec c) {return vmlaq_f32(c, a, b);}
+};
+#else
+struct BaselineOps
+{
+  using Vec = float;
+  static constexpr int kLanes = 1;
+  static constexpr const char * kName = "scalar";
+  static Vec load(const float * p) {return *p;}
+  static void store(float * p, Vec v) {*p = v;}
+  static Vec set1(float x) {return x;}
+  static Vec max0(Vec v) {return v > 0.0f ? v : 0.0f;}
+  static Vec fmadd(Vec a, Vec b, Vec c) {return a * b + c;}
+};
+#endif
+
+int pad(int size)
+{
+  return (size + kPad - 1) / kPad * kPad;
+}
+
+// y[0:padded] = activation(x[0:input_size] * W + b) for packed W.
+// Always inlined into a wrapper compiled for the instruction set of Ops, so
+// the vector types never cross a function boundary without it.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+template<class Ops>
+__attribute__((always_inline)) inline void dense(
+  const float * x, int input_size, const float * weights, const float * bias,
+  int padded, bool relu, float * y)
+{
+  using Vec = typename Ops::Vec;
+  constexpr int lanes = Ops::kLanes;
+  constexpr int tile = kTileVectors * lanes;
+  static_assert(kPad % lanes == 0, "padding must cover whole vectors");
+  for (int col = 0; col < padded; col += tile) {
+    const int vectors = std::min(tile, padded - col) / lanes;
+    Vec acc[kTileVectors];
+    for (int v = 0; v < vectors; ++v) {
+      acc[v] = Ops::load(bias + col + v * lanes);
+    }
+    const float * w = weights + col;
+    for (int i = 0; i < input_size; ++i, w += padded) {
+      const Vec xi = Ops::set1(x[i]);
+      for (int v = 0; v < vectors; ++v) {
+        acc[v] = Ops::fmadd(xi, Ops::load(w + v * lanes), acc[v]);
+      }
+    }
+    for (int v = 0; v < vectors; ++v) {
+      Ops::store(y + col + v * lanes, relu ? Ops::max0(acc[v]) : acc[v]);
+    }
+  }
+}
+#pragma GCC diagnostic pop
+
+void dense_baseline(
+  const float * x, int input_size, const float * weights, const float * bias,
+  int padded, bool relu, float * y)
+{
+  dense<BaselineOps>(x, input_size, weights, bias, padded, relu, y);
+}
+
+#if defined(KEYPOINT_ENGINE_X86)
+KEYPOINT_ENGINE_TARGET_AVX void dense_avx(
+  const float * x, int input_size, const float * weights, const float * bias,
+  int padded, bool relu, float * y)
+{
+  dense<AvxOps>(x, input_size, weights, bias, padded, relu, y);
+}
+#endif
+
+using DenseKernel = void (*)(const float *, int, const float *, const float *, int, bool, float *);
+
+struct Kernel
+{
+  DenseKernel dense;
+  const char * name;
+};
+
+// Pick the widest kernel the running CPU supports, once per process.
+const Kernel & select_kernel()
+{
+  static const Kernel kernel = [] {
+#if defined(KEYPOINT_ENGINE_X86)
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx") && __builtin_cpu_supports("fma")) {
+        return Kernel{dense_avx, AvxOps::kName};
+      }
+#endif
+      return Kernel{dense_baseline, BaselineOps::kName};
+    }();
+  return kernel;
+}
+
+}  // namespace
+
+KeypointEngine::KeypointEngine(const std::vector<DenseLayer> & layers, float softmax_beta)
+: softmax_beta_(softmax_beta)
+{
+  if (layers.empty()) {
+    throw std::invalid_argument("keypoint engine needs at least one layer");
+  }
+
+  std::size_t total = 0;
+  int widest = 0;
+  for (std::size_t l = 0; l < layers.size(); ++l) {
+    const DenseLayer & layer = layers[l];
+    if (layer.input_size <= 0 || layer.output_size <= 0) {
+      throw std::invalid_argument("layer " + std::to_string(l) + " has an empty shape");
+    }
+    if (l > 0 && layer.input_size != layers[l - 1].output_size) {
+      throw std::invalid_argument(
+              "layer " + std::to_string(l) + " expects " + std::to_string(layer.input_size) +
+              " inputs but the previous layer produces " +
+              std::to_string(layers[l - 1].output_size));
+    }
+    const int padded = pad(layer.output_size);
+    total += static_cast<std::size_t>(layer.input_size + 1) * padded;
+    widest = std::max(widest, padded);
+  }
+
+  // Pack every layer into one zero-padded block: transposed weights followed
+  // by the bias, so a whole forward pass touches a few contiguous KB.
+  params_.assign(total, 0.0f);
+  std::size_t offset = 0;
+  for (const DenseLayer & layer : layers) {
+    PackedLayer packed;
+    packed.input_size = layer.input_size;
+    packed.output_size = layer.output_size;
+    packed.padded_size = pad(layer.output_size);
+    packed.activation = layer.activation;
+    packed.weights = offset;
+    packed.bias = offset + static_cast<std::size_t>(layer.input_size) * packed.padded_size;
+
+    float * weights = params_.data() + packed.weights;
+    for (int o = 0; o < layer.output_size; ++o) {
+      for (int i = 0; i < layer.input_size; ++i) {
+        weights[static_cast<std::size_t>(i) * packed.padded_size + o] =
+          layer.weights[static_cast<std::size_t>(o) * layer.input_size + i];
+      }
+    }
+    std::copy(layer.bias, layer.bias + layer.output_size, params_.data() + packed.bias);
+
+    offset = packed.bias + packed.padded_size;
+    layers_.push_back(packed);
+  }
+
+  scratch_[0].assign(widest, 0.0f);
+  scratch_[1].assign(widest, 0.0f);
+  input_size_ = layers.front().input_size;
+  output_size_ = layers.back().output_size;
+}
+
+void KeypointEngine::run(
+  const float * inputs, std::size_t count,
+  float * outputs, std::int32_t * class_ids)
+{
+  for (std::size_t row = 0; row < count; ++row) {
+    float * output = outputs + row * output_size_;
+    run_row(inputs + row * input_size_, output);
+    if (class_ids != nullptr) {
+      class_ids[row] = static_cast<std::int32_t>(
+        std::max_element(output, output + output_size_) - output);
+    }
+  }
+}
+
+void KeypointEngine::run_row(const float * input, float * output)
+{
+  const DenseKernel dense = select_kernel().dense;
+  const float * x = input;
+  int current = 0;
+  for (const PackedLayer & layer : layers_) {
+    float * y = scratch_[current].data();
+    dense(
+      x, layer.input_size, params_.data() + layer.weights, params_.data() + layer.bias,
+      layer.padded_size, layer.activation == Activation::kRelu, y);
+    x = y;
+    current ^= 1;
+  }
+
+  if (softmax_beta_ <= 0.0f) {
+    std::copy(x, x + output_size_, output);
+    return;
+  }
+  const float max_logit = *std::max_element(x, x + output_size_);
+  float sum = 0.0f;
+  for (int o = 0; o < output_size_; ++o) {
+    output[o] = std::exp((x[o] - max_logit) * softmax_beta_);
+    sum += output[o];
+  }
+  for (int o = 0; o < output_size_; ++o) {
+    output[o] /= sum;
+  }
+}
+
+const char * KeypointEngine::simd_name()
+{
+  return select_kernel().name;
+}
+
+}  // namespace turtlebot3_nodes
@@ -0,0 +1,76 @@
+// Dense MLP inference for the keypoint classifier.
+//
+// Weights are packed once at construction into a single contiguous block,
+// transposed to [input][padded output] so that each input element is
+// broadcast against whole SIMD vectors of output weights. Inference uses
+// only buffers owned by the engine, so run() never allocates.
+
+#ifndef TURTLEBOT3_NODES__KEYPOINT_ENGINE_HPP_
+#define TURTLEBOT3_NODES__KEYPOINT_ENGINE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace turtlebot3_nodes
+{
+
+enum class Activation : int
+{
+  kNone = 0,
+  kRelu = 1,
+};
+
+struct DenseLayer
+{
+  const float * weights;  // [output_size][input_size], TFLite layout
+  const float * bias;     // [output_size]
+  int input_size;
+  int output_size;
+  Activation activation;
+};
+
+class KeypointEngine
+{
+public:
+  // Throws std::invalid_argument if consecutive layer sizes do not match.
+  // softmax_beta <= 0 leaves the last layer output as raw logits.
+  KeypointEngine(const std::vector<DenseLayer> & layers, float softmax_beta);
+
+  int input_size() const {return input_size_;}
+  int output_size() const {return output_size_;}
+
+  // Classify count rows of input_size floats. Writes output_size floats per
+  // row to outputs and, if class_ids is not null, the argmax of each row.
+  // Not reentrant: the scratch buffers are shared between calls.
+  void run(
+    const float * inputs, std::size_t count,
+    float * outputs, std::int32_t * class_ids);
+
+  // Name of the vector kernel selected for the running CPU.
+  static const char * simd_name();
+
+private:
+  struct PackedLayer
+  {
+    std::size_t weights;  // offset into params_
+    std::size_t bias;     // offset into params_
+    int input_size;
+    int output_size;
+    int padded_size;
+    Activation activation;
+  };
+
+  void run_row(const float * input, float * output);
+
+  std::vector<PackedLayer> layers_;
+  std::vector<float> params_;
+  std::vector<float> scratch_[2];
+  int input_size_;
+  int output_size_;
+  float softmax_beta_;
+};
+
+}  // namespace turtlebot3_nodes
+
+#endif  // TURTLEBOT3_NODES__KEYPOINT_ENGINE_HPP_
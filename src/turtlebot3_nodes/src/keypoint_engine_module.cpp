@@ -0,0 +1,253 @@
+// Python binding for KeypointEngine.
+//
+// Arrays are exchanged through the buffer protocol, so callers pass
+// preallocated float32/int32 numpy arrays and nothing is allocated per call.
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <cstring>
+#include <exception>
+#include <new>
+#include <vector>
+
+#include "keypoint_engine.hpp"
+
+using turtlebot3_nodes::Activation;
+using turtlebot3_nodes::DenseLayer;
+using turtlebot3_nodes::KeypointEngine;
+
+namespace
+{
+
+struct EngineObject
+{
+  PyObject_HEAD
+  KeypointEngine * engine;
+};
+
+// RAII holder so every early return releases the buffers it acquired.
+class Buffer
+{
+public:
+  Buffer() {std::memset(&view_, 0, sizeof(view_));}
+  Buffer(const Buffer &) = delete;
+  Buffer & operator=(const Buffer &) = delete;
+  ~Buffer()
+  {
+    if (view_.obj != nullptr) {
+      PyBuffer_Release(&view_);
+    }
+  }
+
+  // Acquire a C-contiguous buffer of 4-byte elements of the given kind
+  // ('f' for float32, 'i' for int32) with at most two dimensions.
+  bool acquire(PyObject * obj, char kind, bool writable, const char * name)
+  {
+    int flags = PyBUF_C_CONTIGUOUS | PyBUF_FORMAT;
+    if (writable) {
+      flags |= PyBUF_WRITABLE;
+    }
+    if (PyObject_GetBuffer(obj, &view_, flags) != 0) {
+      return false;
+    }
+    const char * format = view_.format != nullptr ? view_.format : "B";
+    const char code = format[std::strlen(format) - 1];
+    const bool matches = kind == 'f' ? code == 'f' : (code == 'i' || code == 'l');
+    if (!matches || view_.itemsize != 4 || view_.ndim < 1 || view_.ndim > 2) {
+      PyErr_Format(
+        PyExc_TypeError, "%s must be a 1-D or 2-D contiguous %s array", name,
+        kind == 'f' ? "float32" : "int32");
+      return false;
+    }
+    return true;
+  }
+
+  Py_ssize_t rows() const {return view_.ndim == 2 ? view_.shape[0] : 1;}
+  Py_ssize_t cols() const {return view_.shape[view_.ndim - 1];}
+  Py_ssize_t size() const {return view_.len / view_.itemsize;}
+  void * data() const {return view_.buf;}
+
+private:
+  Py_buffer view_;
+};
+
+int Engine_init(EngineObject * self, PyObject * args, PyObject * kwargs)
+{
+  static const char * keywords[] = {"layers", "softmax_beta", nullptr};
+  PyObject * layers_arg = nullptr;
+  float softmax_beta = 1.0f;
+  if (!PyArg_ParseTupleAndKeywords(
+      args, kwargs, "O|f", const_cast<char **>(keywords), &layers_arg, &softmax_beta))
+  {
+    return -1;
+  }
+
+  PyObject * sequence = PySequence_Fast(layers_arg, "layers must be a sequence");
+  if (sequence == nullptr) {
+    return -1;
+  }
+  const Py_ssize_t count = PySequence_Fast_GET_SIZE(sequence);
+  std::vector<Buffer> buffers(2 * count);
+  std::vector<DenseLayer> layers;
+  for (Py_ssize_t l = 0; l < count; ++l) {
+    PyObject * weights = nullptr;
+    PyObject * bias = nullptr;
+    int activation = 0;
+    PyObject * item = PySequence_Fast_GET_ITEM(sequence, l);
+    if (!PyArg_ParseTuple(item, "OOi", &weights, &bias, &activation) ||
+      !buffers[2 * l].acquire(weights, 'f', false, "layer weights") ||
+      !buffers[2 * l + 1].acquire(bias, 'f', false, "layer bias"))
+    {
+      Py_DECREF(sequence);
+      return -1;
+    }
+    const Buffer & w = buffers[2 * l];
+    const Buffer & b = buffers[2 * l + 1];
+    if (b.size() != w.rows()) {
+      PyErr_Format(PyExc_ValueError, "layer %zd bias does not match its weights", l);
+      Py_DECREF(sequence);
+      return -1;
+    }
+    layers.push_back(
+      DenseLayer{
+        static_cast<const float *>(w.data()), static_cast<const float *>(b.data()),
+        static_cast<int>(w.cols()), static_cast<int>(w.rows()),
+        activation == 1 ? Activation::kRelu : Activation::kNone});
+  }
+  Py_DECREF(sequence);
+
+  try {
+    auto engine = new KeypointEngine(layers, softmax_beta);
+    delete self->engine;
+    self->engine = engine;
+  } catch (const std::exception & e) {
+    PyErr_SetString(PyExc_ValueError, e.what());
+    return -1;
+  }
+  return 0;
+}
+
+void Engine_dealloc(EngineObject * self)
+{
+  delete self->engine;
+  Py_TYPE(self)->tp_free(reinterpret_cast<PyObject *>(self));
+}
+
+PyObject * Engine_run(EngineObject * self, PyObject * args)
+{
+  if (self->engine == nullptr) {
+    PyErr_SetString(PyExc_RuntimeError, "engine is not initialized");
+    return nullptr;
+  }
+  PyObject * inputs_arg = nullptr;
+  PyObject * outputs_arg = nullptr;
+  PyObject * ids_arg = Py_None;
+  if (!PyArg_ParseTuple(args, "OO|O", &inputs_arg, &outputs_arg, &ids_arg)) {
+    return nullptr;
+  }
+
+  Buffer inputs, outputs, ids;
+  if (!inputs.acquire(inputs_arg, 'f', false, "inputs") ||
+    !outputs.acquire(outputs_arg, 'f', true, "outputs") ||
+    (ids_arg != Py_None && !ids.acquire(ids_arg, 'i', true, "class_ids")))
+  {
+    return nullptr;
+  }
+
+  const Py_ssize_t rows = inputs.rows();
+  if (inputs.cols() != self->engine->input_size()) {
+    PyErr_Format(
+      PyExc_ValueError, "expected %d input features, got %zd",
+      self->engine->input_size(), inputs.cols());
+    return nullptr;
+  }
+  if (outputs.size() < rows * self->engine->output_size()) {
+    PyErr_SetString(PyExc_ValueError, "outputs is too small for the batch");
+    return nullptr;
+  }
+  if (ids_arg != Py_None && ids.size() < rows) {
+    PyErr_SetString(PyExc_ValueError, "class_ids is too small for the batch");
+    return nullptr;
+  }
+
+  // Calls take microseconds, so the GIL is kept: it also serializes access
+  // to the engine's scratch buffers.
+  self->engine->run(
+    static_cast<const float *>(inputs.data()), static_cast<std::size_t>(rows),
+    static_cast<float *>(outputs.data()),
+    ids_arg != Py_None ? static_cast<std::int32_t *>(ids.data()) : nullptr);
+  Py_RETURN_NONE;
+}
+
+PyObject * Engine_get_input_size(EngineObject * self, void *)
+{
+  return PyLong_FromLong(self->engine != nullptr ? self->engine->input_size() : 0);
+}
+
+PyObject * Engine_get_output_size(EngineObject * self, void *)
+{
+  return PyLong_FromLong(self->engine != nullptr ? self->engine->output_size() : 0);
+}
+
+PyMethodDef Engine_methods[] = {
+  {"run", reinterpret_cast<PyCFunction>(Engine_run), METH_VARARGS,
+    "run(inputs, outputs, class_ids=None)\n\n"
+    "Classify each row of inputs into outputs (and argmax into class_ids)."},
+  {nullptr, nullptr, 0, nullptr},
+};
+
+PyGetSetDef Engine_getset[] = {
+  {"input_size", reinterpret_cast<getter>(Engine_get_input_size), nullptr,
+    "Number of input features.", nullptr},
+  {"output_size", reinterpret_cast<getter>(Engine_get_output_size), nullptr,
+    "Number of output classes.", nullptr},
+  {nullptr, nullptr, nullptr, nullptr, nullptr},
+};
+
+PyTypeObject EngineType = {
+  PyVarObject_HEAD_INIT(nullptr, 0)
+};
+
+PyModuleDef module_def = {
+  PyModuleDef_HEAD_INIT,
+  "_keypoint_engine",
+  "Native dense-layer engine for the keypoint classifier.",
+  -1,
+  nullptr,
+};
+
+}  // namespace
+
+PyMODINIT_FUNC PyInit__keypoint_engine()
+{
+  EngineType.tp_name = "turtlebot3_nodes._keypoint_engine.Engine";
+  EngineType.tp_basicsize = sizeof(EngineObject);
+  EngineType.tp_flags = Py_TPFLAGS_DEFAULT;
+  EngineType.tp_doc =
+    "Engine(layers, softmax_beta=1.0)\n\n"
+    "layers is a sequence of (weights[out, in], bias[out], activation) with\n"
+    "float32 arrays and activation 0 (none) or 1 (relu).";
+  EngineType.tp_new = PyType_GenericNew;
+  EngineType.tp_init = reinterpret_cast<initproc>(Engine_init);
+  EngineType.tp_dealloc = reinterpret_cast<destructor>(Engine_dealloc);
+  EngineType.tp_methods = Engine_methods;
+  EngineType.tp_getset = Engine_getset;
+  if (PyType_Ready(&EngineType) < 0) {
+    return nullptr;
+  }
+
+  PyObject * module = PyModule_Create(&module_def);
+  if (module == nullptr) {
+    return nullptr;
+  }
+  Py_INCREF(&EngineType);
+  if (PyModule_AddObject(module, "Engine", reinterpret_cast<PyObject *>(&EngineType)) < 0 ||
+    PyModule_AddStringConstant(module, "SIMD", KeypointEngine::simd_name()) < 0)
+  {
+    Py_DECREF(&EngineType);
+    Py_DECREF(module);
+    return nullptr;
+  }
+  return module;
+}
@@ -0,0 +1,233 @@
+import os
+from types import SimpleNamespace
+
+import numpy as np
+import pytest
+
+from turtlebot3_nodes.gesture_pipeline import calc_landmark_list, pre_process_landmark
+from turtlebot3_nodes.gesture_recording import (
+    FLAG_HAND, FLAG_SCALED, FLAG_STEP, HEADER, KIND_COMMAND, KIND_FRAME, KIND_SESSION,
+    MAGIC, NO_GESTURE, RECORD_DTYPE, VERSION, GestureRecorder, load_recording,
+    preprocess_landmarks, split_sessions)
+
+MODEL_PATH = os.path.join(
+    os.path.dirname(__file__), '..', 'model', 'keypoint_classifier',
+    'keypoint_classifier.tflite')
+
+
+def random_hand(rng, spread=1.0):
+    """Normalized landmarks, partly outside the frame like MediaPipe reports"""
+    return rng.uniform(-0.1 * spread, 1.0 + 0.1 * spread, size=(21, 3)).astype(np.float32)
+
+
+def node_features(landmarks, width, height):
+    """Features computed the way GesturePublisher does for one hand"""
+    hand = SimpleNamespace(landmark=[
+        SimpleNamespace(x=float(x), y=float(y), z=float(z)) for x, y, z in landmarks])
+    return pre_process_landmark(calc_landmark_list(width, height, hand))
+
+
+def test_format_is_pinned():
+    # Changing the record layout must come with a new VERSION, or old
+    # recordings would be misread
+    assert (VERSION, RECORD_DTYPE.itemsize, HEADER.size) == (2, 476, 16)
+
+
+def test_round_trip_and_append(tmp_path):
+    path = str(tmp_path / 'session.tb3rec')
+    rng = np.random.default_rng(0)
+    hands = [random_hand(rng) for _ in range(3)]
+
+    recorder = GestureRecorder(path, flush_every=2)
+    for seq, landmarks in enumerate(hands):
+        recorder.write_frame(1000 + seq, seq, seq, 0.5 + seq * 0.1, landmarks, (640, 480),
+                             node_features(landmarks, 640, 480))
+    recorder.write_frame(2000, 7, 4, 0.9)
+    recorder.flush()
+    assert len(load_recording(path)) == 5
+    recorder.write_command(1001, (0.1, -0.2), class_id=2, step_stamp=5_000, dt=0.05)
+    recorder.close()
+
+    # Reopening appends a new session behind the existing records
+    recorder = GestureRecorder(path)
+    recorder.write_command(2000, (0.22, 0.0))
+    recorder.close()
+
+    records = load_recording(path)
+    assert isinstance(records, np.memmap)
+    assert records['kind'].tolist() == [
+        KIND_SESSION, *[KIND_FRAME] * 4, KIND_COMMAND, KIND_SESSION, KIND_COMMAND]
+    assert records['capture_stamp'][0] <= records['capture_stamp'][6]
+    sessions = split_sessions(records)
+    assert [len(session) for session in sessions] == [5, 1]
+    frames = sessions[0][:4]
+    assert frames['capture_stamp'].tolist() == [1000, 1001, 1002, 2000]
+    assert frames['seq'].tolist() == [0, 1, 2, 7]
+    assert frames['flags'].tolist() == [FLAG_HAND] * 3 + [0]
+    np.testing.assert_array_equal(frames['landmarks'][:3], np.array(hands))
+    assert frames['image_size'][0].tolist() == [640, 480]
+    np.testing.assert_allclose(frames['confidence'], [0.5, 0.6, 0.7, 0.9], rtol=1e-6)
+    assert not frames['features'][3].any()
+
+    step, observed = sessions[0][4], sessions[1][0]
+    assert step['flags'] == FLAG_STEP | FLAG_SCALED
+    assert (step['capture_stamp'], step['step_stamp'], step['class_id']) == (1001, 5_000, 2)
+    assert step['dt'] == 0.05
+    assert step['twist'].tolist() == [0.1, -0.2]
+    assert observed['flags'] == 0
+    assert observed['class_id'] == NO_GESTURE
+    assert observed['twist'].tolist() == [0.22, 0.0]
+
+    # A record cut short by a crash is ignored
+    with open(path, 'ab') as f:
+        f.write(b'\x01' * (RECORD_DTYPE.itemsize // 2))
+    assert len(load_recording(path)) == 8
+
+
+def test_empty_recording(tmp_path):
+    path = str(tmp_path / 'empty.tb3rec')
+    GestureRecorder(path).close()
+    records = load_recording(path)
+    assert records['kind'].tolist() == [KIND_SESSION]
+    assert split_sessions(records) == []
+
+
+@pytest.mark.parametrize('header, match', [
+    (b'TB3', 'truncated header'),
+    (HEADER.pack(b'NOTAREC\x00', VERSION, RECORD_DTYPE.itemsize), 'not a gesture recording'),
+    (HEADER.pack(MAGIC, VERSION - 1, RECORD_DTYPE.itemsize), 'unsupported recording version'),
+    (HEADER.pack(MAGIC, VERSION, RECORD_DTYPE.itemsize - 4), 'record size'),
+])
+def test_rejects_bad_header(tmp_path, header, match):
+    path = str(tmp_path / 'bad.tb3rec')
+    with open(path, 'wb') as f:
+        f.write(header)
+    with pytest.raises(ValueError, match=match):
+        load_recording(path)
+    with pytest.raises(ValueError, match=match):
+        GestureRecorder(path)
+
+
+def test_preprocess_matches_node():
+    rng = np.random.default_rng(1)
+    sizes = np.array([(640, 480), (1280, 720), (320, 240), (17, 9)] * 50, dtype=np.uint16)
+    landmarks = np.array([random_hand(rng, spread=3.0) for _ in sizes])
+    # Every landmark on the wrist exercises the division-by-zero guard
+    landmarks[0] = landmarks[0, 0]
+
+    expected = np.array([node_features(hand, int(width), int(height))
+                         for hand, (width, height) in zip(landmarks, sizes)],
+                        dtype=np.float32)
+    np.testing.assert_array_equal(preprocess_landmarks(landmarks, sizes), expected)
+    assert not expected[0].any()
+
+
+def record_session(path, clock, rng, frames, hand=True):
+    """Record one composed teleop session; frames every ~150 ms with timer ticks between"""
+    import rclpy
+    from rclpy.parameter import Parameter
+    from builtin_interfaces.msg import Time
+    from turtlebot3_gesture_msgs.msg import Gesture
+    from turtlebot3_nodes import turtlebot3_cmd_vel
+    from turtlebot3_nodes.keypoint_classifier import KeypointClassifier
+
+    recorder = GestureRecorder(path)
+    classifier = KeypointClassifier(MODEL_PATH, use_native=False)
+    first_stamp = int(clock[0] * 1e9)
+    rclpy.init()
+    try:
+        node = turtlebot3_cmd_vel.CmdVelPublisher(
+            subscribe=False, parameter_overrides=[Parameter('event_driven', value=True)],
+            listeners=[recorder.on_command])
+        next_tick = clock[0] + node.ramp.period
+        class_id, confidence = Gesture.NONE, 0.0
+        for seq in range(frames):
+            # The control timer keeps ticking every 100 ms between frames
+            frame_time = clock[0] + 0.15 + rng.uniform(0.0, 0.02)
+            while next_tick < frame_time:
+                clock[0] = next_tick
+                node.control_loop()
+                next_tick += node.ramp.period
+            clock[0] = frame_time
+
+            stamp_ns = first_stamp + seq * 150_000_000
+            stamp = Time(sec=stamp_ns // 1_000_000_000, nanosec=stamp_ns % 1_000_000_000)
+            if not hand or seq % 5 == 4:
+                # No hand: the last gesture is published again
+                recorder.write_frame(stamp_ns, seq, class_id, confidence)
+            else:
+                landmarks = random_hand(rng)
+                features = node_features(landmarks, 640, 480)
+                class_id, confidence = classifier(features)
+                recorder.write_frame(stamp_ns, seq, class_id, confidence,
+                                     landmarks, (640, 480), features)
+            msg = Gesture()
+            msg.header.stamp = stamp
+            msg.class_id = class_id
+            node.listener_callback(msg)
+        node.destroy_node()
+    finally:
+        rclpy.shutdown()
+        recorder.close()
+
+
+def replay_main(path, *args):
+    from turtlebot3_nodes import gesture_replay
+    return gesture_replay.main(
+        [path, '--model', MODEL_PATH, '--backend', 'numpy', '--repeat', '1', *args])
+
+
+@pytest.fixture
+def clock(monkeypatch):
+    """Monotonic time the cmd_vel ramp sees, advanced by the test"""
+    pytest.importorskip('rclpy')
+    from turtlebot3_nodes import turtlebot3_cmd_vel
+    now = [100.0]
+    monkeypatch.setattr(turtlebot3_cmd_vel.time, 'monotonic', lambda: now[0])
+    return now
+
+
+def test_replay_reproduces_composed_ramp(tmp_path, clock):
+    """Frames slower than the control period, with timer ticks in between"""
+    path = str(tmp_path / 'composed.tb3rec')
+    record_session(path, clock, np.random.default_rng(2), 40)
+
+    records = load_recording(path)
+    steps = records[records['kind'] == KIND_COMMAND]
+    assert len(steps) > 40 and (steps['flags'] & FLAG_STEP).all()
+    assert replay_main(path, '--batch', '8', '--fail-on-diff') == 0
+    # A different controller shows up as command diffs
+    assert replay_main(path, '--linear-vel-increment', '0.02',
+                       '--angular-vel-increment', '0.02', '--fail-on-diff') == 1
+
+
+def test_replay_resets_state_per_session(tmp_path, clock):
+    """A session appended after a moving one starts from a stopped ramp"""
+    from turtlebot3_nodes.gesture_replay import replay, split_recording
+    from turtlebot3_nodes.keypoint_classifier import KeypointClassifier
+    from turtlebot3_nodes.velocity_ramp import (
+        ANGULAR_VEL_INCREMENT, ANGULAR_VEL_LIMIT, CONTROL_PERIOD,
+        LINEAR_VEL_INCREMENT, LINEAR_VEL_LIMIT)
+    path = str(tmp_path / 'sessions.tb3rec')
+    rng = np.random.default_rng(2)
+    record_session(path, clock, rng, 40)
+    clock[0] += 1000.0
+    record_session(path, clock, rng, 10, hand=False)
+
+    sessions = split_sessions(load_recording(path))
+    assert len(sessions) == 2
+    first, second = (split_recording(session) for session in sessions)
+    assert first[1]['twist'][-1].any()
+    assert not second[1]['twist'].any()
+    assert replay_main(path, '--fail-on-diff') == 0
+
+    # Without the session boundary the first session's motion carries over
+    options = SimpleNamespace(
+        batch=64, linear_vel_limit=LINEAR_VEL_LIMIT, angular_vel_limit=ANGULAR_VEL_LIMIT,
+        linear_vel_increment=LINEAR_VEL_INCREMENT,
+        angular_vel_increment=ANGULAR_VEL_INCREMENT, control_period=CONTROL_PERIOD)
+    frames = np.concatenate([first[0], second[0]])
+    commands = np.concatenate([first[1], second[1]])
+    result = replay(frames, commands, KeypointClassifier(MODEL_PATH, use_native=False),
+                    options)
+    assert np.abs(result.twist[len(first[1]):]).max() > 0.0
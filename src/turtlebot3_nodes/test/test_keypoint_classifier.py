@@ -0,0 +1,85 @@
+import os
+
+import numpy as np
+import pytest
+
+from turtlebot3_nodes.keypoint_classifier import (
+    ACTIVATION_NONE, ACTIVATION_RELU, KeypointClassifier, load_dense_layers)
+from turtlebot3_nodes.keypoint_classifier_benchmark import synthetic_landmarks
+
+MODEL_PATH = os.path.join(
+    os.path.dirname(__file__), '..', 'model', 'keypoint_classifier',
+    'keypoint_classifier.tflite')
+
+
+def native_engine():
+    return pytest.importorskip('turtlebot3_nodes._keypoint_engine')
+
+
+def test_load_dense_layers():
+    layers, softmax_beta = load_dense_layers(MODEL_PATH)
+    assert [weights.shape for weights, _, _ in layers] == [(20, 42), (10, 20), (5, 10)]
+    assert [bias.shape for _, bias, _ in layers] == [(20,), (10,), (5,)]
+    assert [activation for _, _, activation in layers] == \
+        [ACTIVATION_RELU, ACTIVATION_RELU, ACTIVATION_NONE]
+    assert all(weights.dtype == np.float32 for weights, _, _ in layers)
+    assert softmax_beta > 0.0
+
+
+def test_numpy_outputs_are_probabilities():
+    classifier = KeypointClassifier(MODEL_PATH, use_native=False)
+    ids, outputs = classifier.classify(synthetic_landmarks(16, classifier.input_size))
+    np.testing.assert_allclose(outputs.sum(axis=1), 1.0, rtol=1e-5)
+    np.testing.assert_array_equal(ids, outputs.argmax(axis=1))
+
+
+def test_native_matches_numpy():
+    native_engine()
+    landmarks = synthetic_landmarks(500, 42)
+    native = KeypointClassifier(MODEL_PATH)
+    reference = KeypointClassifier(MODEL_PATH, use_native=False)
+    assert native.backend.startswith('native-')
+
+    native_ids, native_outputs = native.classify(landmarks)
+    native_ids, native_outputs = native_ids.copy(), native_outputs.copy()
+    reference_ids, reference_outputs = reference.classify(landmarks)
+    assert np.abs(native_outputs - reference_outputs).max() < 1e-5
+    np.testing.assert_array_equal(native_ids, reference_ids)
+
+    class_id, confidence = native(landmarks[0])
+    assert class_id == reference_ids[0]
+    assert confidence == pytest.approx(reference_outputs[0, class_id], abs=1e-5)
+
+
+@pytest.mark.parametrize('use_native', [True, False])
+def test_batch_grows_beyond_max_batch(use_native):
+    if use_native:
+        native_engine()
+    landmarks = synthetic_landmarks(20, 42)
+    classifier = KeypointClassifier(MODEL_PATH, max_batch=4, use_native=use_native)
+    single = np.array([classifier(row)[0] for row in landmarks])
+
+    ids, outputs = classifier.classify(landmarks)
+    assert classifier.max_batch >= len(landmarks)
+    assert outputs.shape == (len(landmarks), classifier.num_classes)
+    np.testing.assert_array_equal(ids, single)
+
+
+def test_engine_rejects_bad_buffers():
+    engine_module = native_engine()
+    layers, softmax_beta = load_dense_layers(MODEL_PATH)
+    engine = engine_module.Engine(layers, softmax_beta)
+    assert (engine.input_size, engine.output_size) == (42, 5)
+
+    inputs = np.zeros((4, 42), dtype=np.float32)
+    outputs = np.zeros((4, 5), dtype=np.float32)
+    with pytest.raises(ValueError, match='input features'):
+        engine.run(np.zeros((4, 41), dtype=np.float32), outputs)
+    with pytest.raises(ValueError, match='outputs is too small'):
+        engine.run(inputs, np.zeros((3, 5), dtype=np.float32))
+    with pytest.raises(ValueError, match='class_ids is too small'):
+        engine.run(inputs, outputs, np.zeros(3, dtype=np.int32))
+    with pytest.raises(TypeError):
+        engine.run(inputs.astype(np.float64), outputs)
+    with pytest.raises(ValueError, match='expects'):
+        engine_module.Engine(layers[:1] + layers[2:], softmax_beta)
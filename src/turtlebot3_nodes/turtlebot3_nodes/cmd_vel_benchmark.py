@@ -0,0 +1,168 @@
+#!/usr/bin/env python3
+
+"""Compare gesture-to-cmd_vel latency and CPU of the split and composed setups.
+
+A synthetic source publishes capture-stamped gestures at camera rate and
+switches gesture every few frames. In split mode they cross the 'gesture'
+topic to a separate turtlebot3_cmd_vel process ramping on its 10 Hz timer.
+In composed mode they are handed to an in-process, event-driven
+CmdVelPublisher like turtlebot3_gesture_teleop does. A probe on
+cmd_vel_stamped measures the age of the first command reflecting each new
+gesture. /cmd_vel is remapped so a running robot is not driven.
+"""
+
+import argparse
+import os
+import subprocess
+import time
+
+import rclpy
+from rclpy.executors import SingleThreadedExecutor
+from rclpy.node import Node
+from rclpy.parameter import Parameter
+from geometry_msgs.msg import TwistStamped
+from turtlebot3_gesture_msgs.msg import Gesture
+
+from turtlebot3_nodes.latency_trace import LatencyHistogram
+
+CMD_VEL_TOPIC = '/cmd_vel_benchmark'
+GESTURE_CYCLE = [Gesture.FORWARD, Gesture.LEFT, Gesture.BACKWARD, Gesture.RIGHT, Gesture.STOP]
+
+
+class GestureSource(Node):
+    """Publish (or hand over) a stamped gesture at a fixed frame rate."""
+
+    def __init__(self, rate, hold, listener=None):
+        super().__init__('gesture_benchmark_source')
+        self.publisher = self.create_publisher(Gesture, 'gesture', 10)
+        self.listener = listener
+        self.hold = hold
+        self.frames = 0
+        self.create_timer(1.0 / rate, self.tick)
+
+    def tick(self):
+        msg = Gesture()
+        msg.header.stamp = self.get_clock().now().to_msg()
+        msg.class_id = GESTURE_CYCLE[(self.frames // self.hold) % len(GESTURE_CYCLE)]
+        msg.confidence = 1.0
+        self.frames += 1
+        if self.listener is not None:
+            self.listener(msg)
+        else:
+            self.publisher.publish(msg)
+
+
+class CommandProbe(Node):
+    """Measure how old each newly reflected gesture is when its command arrives."""
+
+    def __init__(self):
+        super().__init__('cmd_vel_benchmark_probe')
+        self.histogram = LatencyHistogram()
+        self.commands = 0
+        self.last_stamp = None
+        self.create_subscription(TwistStamped, 'cmd_vel_stamped', self.callback, 10)
+
+    def callback(self, msg):
+        self.commands += 1
+        stamp = (msg.header.stamp.sec, msg.header.stamp.nanosec)
+        if stamp == self.last_stamp:
+            return
+        self.last_stamp = stamp
+        now = self.get_clock().now().nanoseconds
+        self.histogram.record((now - (stamp[0] * 1_000_000_000 + stamp[1])) * 1e-9)
+
+
+def process_cpu_seconds(pid):
+    """Return user+system CPU seconds consumed by pid so far"""
+    with open(f'/proc/{pid}/stat') as f:
+        fields = f.read().rsplit(')', 1)[1].split()
+    return (int(fields[11]) + int(fields[12])) / os.sysconf('SC_CLK_TCK')
+
+
+def spin_for(executor, seconds):
+    deadline = time.monotonic() + seconds
+    while time.monotonic() < deadline:
+        executor.spin_once(timeout_sec=0.05)
+
+
+def run(mode, options):
+    ros_args = ['--ros-args', '-p', 'publish_stamped:=true', '-p', 'stats_period:=0.0',
+                '-r', f'/cmd_vel:={CMD_VEL_TOPIC}']
+    rclpy.init(args=ros_args)
+    executor = SingleThreadedExecutor()
+    child = None
+    nodes = []
+    if mode == 'split':
+        from ament_index_python.packages import get_package_prefix
+        executable = os.path.join(get_package_prefix('turtlebot3_nodes'),
+                                  'lib', 'turtlebot3_nodes', 'turtlebot3_cmd_vel')
+        child = subprocess.Popen([executable] + ros_args, stdout=subprocess.DEVNULL,
+                                 stderr=subprocess.DEVNULL)
+        source = GestureSource(options.rate, options.hold)
+        nodes.append(source)
+    else:
+        from turtlebot3_nodes.turtlebot3_cmd_vel import CmdVelPublisher
+        cmd_vel_publisher = CmdVelPublisher(
+            subscribe=False, parameter_overrides=[Parameter('event_driven', value=True)])
+        source = GestureSource(options.rate, options.hold, cmd_vel_publisher.listener_callback)
+        nodes += [cmd_vel_publisher, source]
+    probe = CommandProbe()
+    nodes.append(probe)
+    for node in nodes:
+        executor.add_node(node)
+
+    try:
+        # Let discovery settle before measuring
+        spin_for(executor, options.warmup)
+        probe.histogram = LatencyHistogram()
+        probe.commands = 0
+        frames = source.frames
+        cpu_self = time.process_time()
+        cpu_child = process_cpu_seconds(child.pid) if child else 0.0
+        start = time.monotonic()
+
+        spin_for(executor, options.duration)
+
+        elapsed = time.monotonic() - start
+        cpu_self = time.process_time() - cpu_self
+        if child:
+            cpu_child = process_cpu_seconds(child.pid) - cpu_child
+        frames = source.frames - frames
+    finally:
+        if child:
+            child.terminate()
+            child.wait()
+        executor.shutdown()
+        for node in nodes:
+            node.destroy_node()
+        rclpy.shutdown()
+
+    counts, total = probe.histogram.snapshot()
+    changes = sum(counts)
+    print(f'{mode}: {frames} gestures, {changes} changes reflected, '
+          f'{probe.commands / elapsed:.1f} commands/s')
+    if changes:
+        print(f'  gesture->cmd_vel latency mean={total / changes * 1e3:.2f}ms '
+              f'p50={LatencyHistogram.percentile(counts, 0.5) * 1e3:.2f}ms '
+              f'p99={LatencyHistogram.percentile(counts, 0.99) * 1e3:.2f}ms '
+              f'max={LatencyHistogram.percentile(counts, 1.0) * 1e3:.2f}ms')
+    print(f'  cpu {100.0 * (cpu_self + cpu_child) / elapsed:.1f}% '
+          f'(benchmark process {100.0 * cpu_self / elapsed:.1f}%, '
+          f'cmd_vel process {100.0 * cpu_child / elapsed:.1f}%)')
+
+
+def main(args=None):
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--mode', choices=['split', 'composed', 'both'], default='both')
+    parser.add_argument('--rate', type=float, default=30.0, help='gestures per second')
+    parser.add_argument('--hold', type=int, default=15, help='frames per gesture')
+    parser.add_argument('--duration', type=float, default=10.0)
+    parser.add_argument('--warmup', type=float, default=2.0)
+    options = parser.parse_args(args)
+
+    for mode in ['split', 'composed'] if options.mode == 'both' else [options.mode]:
+        run(mode, options)
+
+
+if __name__ == '__main__':
+    main()
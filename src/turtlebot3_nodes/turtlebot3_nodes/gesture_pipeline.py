@@ -0,0 +1,70 @@
+#!/usr/bin/env python3
+
+"""Building blocks for the pipelined gesture recognition mode."""
+
+import itertools
+import threading
+
+
+def calc_landmark_list(image_width, image_height, landmarks):
+    """Convert normalized MediaPipe landmarks to pixel coordinates."""
+    return [
+        [min(int(landmark.x * image_width), image_width - 1),
+         min(int(landmark.y * image_height), image_height - 1)]
+        for landmark in landmarks.landmark
+    ]
+
+
+def pre_process_landmark(landmark_list):
+    """Make pixel landmarks wrist-relative, flatten and normalize to [-1, 1]."""
+    # Relative to wrist (landmark 0)
+    base_x, base_y = landmark_list[0]
+    relative_landmarks = [[x - base_x, y - base_y] for x, y in landmark_list]
+
+    # Flatten and normalize
+    flattened = list(itertools.chain.from_iterable(relative_landmarks))
+    max_val = max(abs(x) for x in flattened) or 1.0  # Avoid division by zero
+    return [x / max_val for x in flattened]
+
+
+class Frame:
+    """Camera frame tagged with its capture time and sequence number."""
+
+    __slots__ = ('image', 'stamp', 'capture_stamp', 'seq')
+
+    def __init__(self, image, stamp, capture_stamp, seq):
+        self.image = image
+        self.stamp = stamp  # time.monotonic() right after the grab
+        self.capture_stamp = capture_stamp  # same instant on the ROS clock
+        self.seq = seq
+
+
+class LatestSlot:
+    """Single-entry handoff where a newer item replaces an unconsumed one."""
+
+    def __init__(self):
+        self._cond = threading.Condition()
+        self._item = None
+        self._closed = False
+
+    def put(self, item):
+        """Store item; return True if it replaced one nobody took."""
+        with self._cond:
+            replaced = self._item is not None
+            self._item = item
+            self._cond.notify()
+            return replaced
+
+    def take(self, timeout=None):
+        """Wait for an item; return None on timeout or once closed."""
+        with self._cond:
+            if self._item is None and not self._closed:
+                self._cond.wait(timeout)
+            item, self._item = self._item, None
+            return item
+
+    def close(self):
+        """Wake up any waiting consumer for shutdown."""
+        with self._cond:
+            self._closed = True
+            self._cond.notify_all()
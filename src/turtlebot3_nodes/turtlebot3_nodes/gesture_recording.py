@@ -0,0 +1,229 @@
+#!/usr/bin/env python3
+
+"""Append-only binary recording of gesture pipeline frames and commands.
+
+A recording is a small header followed by fixed-size little-endian records
+(RECORD_DTYPE). The whole file can be memory-mapped as one numpy structured
+array. A recording that was cut short loses at most its last partial record.
+
+There are three kinds of records:
+- A session record starts every recording session. Sessions may be
+  appended to the same file; each starts from a fresh node.
+- A frame record holds one processed camera frame.
+- A command record holds one velocity command.
+
+A command recorded at the ramp step itself (FLAG_STEP) carries two things:
+- the time of the step and its dt;
+- the capture stamp of the last gesture the ramp had received.
+
+Replaying the gestures and steps in that order reproduces the command
+exactly. A command observed on cmd_vel_stamped carries only the capture
+stamp of the gesture that set its position.
+"""
+
+import os
+import struct
+import threading
+import time
+
+import numpy as np
+
+MAGIC = b'TB3GREC\x00'
+VERSION = 2
+# Magic, format version, record size in bytes
+HEADER = struct.Struct('<8sII')
+
+NUM_LANDMARKS = 21
+FEATURE_SIZE = 2 * NUM_LANDMARKS
+
+# Gesture.NONE, for frames before the first hand and unknown positions
+NO_GESTURE = 255
+
+# Record kinds
+KIND_FRAME = 0
+KIND_COMMAND = 1
+KIND_SESSION = 2
+
+# Record flags
+FLAG_HAND = 0x1  # frame: a hand was detected; landmarks and features are valid
+FLAG_STEP = 0x2  # command: recorded at the ramp step; step_stamp and dt are valid
+FLAG_SCALED = 0x4  # command: the ramp step was scaled by dt
+
+RECORD_DTYPE = np.dtype([
+    # Frame: ROS time the frame was captured. Command: capture stamp of the
+    # gesture behind it (see module doc), 0 before the first gesture.
+    # Session: wall time the recorder was opened. In ns.
+    ('capture_stamp', '<i8'),
+    ('step_stamp', '<i8'),  # command: monotonic time of the ramp step, ns
+    ('dt', '<f8'),  # command: seconds the ramp step was scaled to
+    ('twist', '<f8', (2,)),  # command: linear.x, angular.z
+    ('seq', '<u4'),  # frame: capture sequence number; gaps are dropped frames
+    ('kind', 'u1'),
+    ('class_id', 'u1'),  # frame: Gesture.class_id as published; command: position
+    ('flags', '<u2'),
+    ('image_size', '<u2', (2,)),  # frame: width, height the landmarks were scaled to
+    ('confidence', '<f4'),  # frame: classifier confidence
+    ('landmarks', '<f4', (NUM_LANDMARKS, 3)),  # frame: normalized MediaPipe x, y, z
+    ('features', '<f4', (FEATURE_SIZE,)),  # frame: pre_process_landmark output
+])
+
+
+def stamp_to_ns(stamp):
+    """Convert a builtin_interfaces/Time to integer nanoseconds (None -> 0)."""
+    if stamp is None:
+        return 0
+    return stamp.sec * 1_000_000_000 + stamp.nanosec
+
+
+class GestureRecorder:
+    """Append a session of frame and command records to a recording file.
+
+    Records are staged in a preallocated buffer and written in blocks of
+    flush_every, so writers only touch the disk once per block. Frames and
+    commands may be written from different threads.
+    """
+
+    def __init__(self, path, flush_every=30):
+        self.path = path
+        exists = os.path.exists(path) and os.path.getsize(path) > 0
+        if exists:
+            read_header(path)
+        self.file = open(path, 'ab')
+        if not exists:
+            self.file.write(HEADER.pack(MAGIC, VERSION, RECORD_DTYPE.itemsize))
+            self.file.flush()
+        self.lock = threading.Lock()
+        self.buffer = np.zeros(flush_every, dtype=RECORD_DTYPE)
+        self.pending = 0
+        self.frames = 0
+        self.commands = 0
+        # Appended sessions must not carry gesture or ramp state across
+        with self.lock:
+            record = self._next()
+            record['kind'] = KIND_SESSION
+            record['capture_stamp'] = time.time_ns()
+            self._commit()
+
+    def write_frame(self, capture_stamp, seq, class_id, confidence,
+                    landmarks=None, image_size=None, features=None):
+        """Append one frame; landmarks and features only when a hand was seen."""
+        with self.lock:
+            record = self._next()
+            record['kind'] = KIND_FRAME
+            record['capture_stamp'] = capture_stamp
+            record['seq'] = seq
+            record['class_id'] = class_id
+            record['confidence'] = confidence
+            if landmarks is not None:
+                record['flags'] = FLAG_HAND
+                record['landmarks'] = landmarks
+                record['image_size'] = image_size
+                record['features'] = features
+            self.frames += 1
+            self._commit()
+
+    def write_command(self, capture_stamp, twist, class_id=NO_GESTURE, step_stamp=None,
+                      dt=None):
+        """Append one command; step_stamp only when recorded at the ramp step."""
+        with self.lock:
+            record = self._next()
+            record['kind'] = KIND_COMMAND
+            record['capture_stamp'] = capture_stamp
+            record['twist'] = twist
+            record['class_id'] = class_id
+            flags = 0
+            if step_stamp is not None:
+                flags |= FLAG_STEP
+                record['step_stamp'] = step_stamp
+            if dt is not None:
+                flags |= FLAG_SCALED
+                record['dt'] = dt
+            record['flags'] = flags
+            self.commands += 1
+            self._commit()
+
+    def on_command(self, cmd_msg, class_id, gesture_stamp, step_time, dt):
+        """CmdVelPublisher command listener recording every ramp step"""
+        self.write_command(
+            stamp_to_ns(gesture_stamp), (cmd_msg.linear.x, cmd_msg.angular.z),
+            class_id, int(step_time * 1e9), dt)
+
+    def _next(self):
+        self.buffer[self.pending] = 0
+        return self.buffer[self.pending]
+
+    def _commit(self):
+        self.pending += 1
+        if self.pending == len(self.buffer):
+            self._flush()
+
+    def _flush(self):
+        if self.pending and self.file is not None:
+            self.file.write(memoryview(self.buffer[:self.pending]))
+            self.file.flush()
+        self.pending = 0
+
+    def flush(self):
+        """Write staged records to the file"""
+        with self.lock:
+            self._flush()
+
+    def close(self):
+        """Flush and close the file; further writes are dropped"""
+        with self.lock:
+            if self.file is not None:
+                self._flush()
+                self.file.close()
+                self.file = None
+
+
+def read_header(path):
+    """Validate the header of a recording and return its size in bytes."""
+    with open(path, 'rb') as f:
+        data = f.read(HEADER.size)
+    if len(data) < HEADER.size:
+        raise ValueError(f'{path}: truncated header')
+    magic, version, record_size = HEADER.unpack(data)
+    if magic != MAGIC:
+        raise ValueError(f'{path}: not a gesture recording')
+    if version != VERSION or record_size != RECORD_DTYPE.itemsize:
+        raise ValueError(f'{path}: unsupported recording version {version} '
+                         f'(record size {record_size})')
+    return HEADER.size
+
+
+def load_recording(path):
+    """Memory-map a recording as a read-only RECORD_DTYPE array."""
+    offset = read_header(path)
+    count = (os.path.getsize(path) - offset) // RECORD_DTYPE.itemsize
+    if count == 0:
+        return np.zeros(0, dtype=RECORD_DTYPE)
+    return np.memmap(path, dtype=RECORD_DTYPE, mode='r', offset=offset, shape=(count,))
+
+
+def split_sessions(records):
+    """Split records at their session records; empty sessions are dropped"""
+    sessions = []
+    for session in np.split(records, np.flatnonzero(records['kind'] == KIND_SESSION)):
+        if len(session) and session['kind'][0] == KIND_SESSION:
+            session = session[1:]
+        if len(session):
+            sessions.append(session)
+    return sessions
+
+
+def preprocess_landmarks(landmarks, image_size):
+    """Vectorized calc_landmark_list followed by pre_process_landmark.
+
+    landmarks is (count, 21, 3) normalized MediaPipe coordinates and
+    image_size (count, 2) the frame width and height. Returns the (count, 42)
+    float32 feature vectors the node would have classified.
+    """
+    size = image_size.astype(np.float64)[:, np.newaxis, :]
+    points = np.trunc(landmarks[:, :, :2].astype(np.float64) * size)
+    np.minimum(points, size - 1.0, out=points)
+    points -= points[:, :1, :]
+    flattened = points.reshape(len(points), FEATURE_SIZE)
+    scale = np.abs(flattened).max(axis=1, keepdims=True)
+    scale[scale == 0.0] = 1.0
+    return (flattened / scale).astype(np.float32)
@@ -0,0 +1,245 @@
+#!/usr/bin/env python3
+
+"""Replay gesture recordings through preprocessing, classifier and ramp offline.
+
+Each recording made with the gesture publisher's record_file parameter is
+replayed as fast as possible:
+- the landmarks are preprocessed again and classified in batches;
+- the published gestures are derived from the resulting classes;
+- the cmd_vel velocity ramp is stepped at every recorded ramp step, timer
+  ticks included, with the recorded dt and the last gesture the ramp had
+  received.
+
+The tool reports throughput and the latency distribution of each stage. It
+also reports where the replayed features, gestures, positions and commands
+differ from the recording, so classifier and controller changes can be
+checked without a camera or a running ROS graph.
+
+Sessions appended to the same recording are replayed separately, each from
+a fresh node state. Only the composed turtlebot3_gesture_teleop records its
+ramp steps. A split
+setup's commands are observed on cmd_vel_stamped without the time of their
+step, so they are counted but not replayed.
+"""
+
+import argparse
+import time
+
+import numpy as np
+
+from turtlebot3_nodes.gesture_recording import (
+    FEATURE_SIZE, FLAG_HAND, FLAG_SCALED, FLAG_STEP, KIND_COMMAND, KIND_FRAME,
+    NO_GESTURE, load_recording, preprocess_landmarks, split_sessions)
+from turtlebot3_nodes.keypoint_classifier import KeypointClassifier
+from turtlebot3_nodes.keypoint_classifier_benchmark import default_model_path
+from turtlebot3_nodes.latency_trace import LatencyHistogram
+from turtlebot3_nodes.turtlebot3_cmd_vel import GESTURE_POSITIONS, POSITION_GESTURES
+from turtlebot3_nodes.velocity_ramp import (
+    ANGULAR_VEL_INCREMENT, ANGULAR_VEL_LIMIT, CONTROL_PERIOD,
+    LINEAR_VEL_INCREMENT, LINEAR_VEL_LIMIT, VelocityRamp)
+
+# Stages timed per batch of frames, then per ramp step
+BATCH_STAGES = ['preprocess', 'classify', 'gesture']
+STAGES = BATCH_STAGES + ['ramp']
+STOP = POSITION_GESTURES['Stop']
+
+
+class Replay:
+    """Replayed outputs of one recording plus per-stage timing."""
+
+    def __init__(self, frame_count, command_count):
+        self.features = np.zeros((frame_count, FEATURE_SIZE), dtype=np.float32)
+        self.class_ids = np.full(frame_count, NO_GESTURE, dtype=np.int32)
+        self.confidence = np.zeros(frame_count, dtype=np.float32)
+        # Ramp position after each frame, as a Gesture class id
+        self.positions = np.full(frame_count, STOP, dtype=np.int32)
+        self.command_positions = np.full(command_count, NO_GESTURE, dtype=np.int32)
+        self.twist = np.zeros((command_count, 2))
+        self.histograms = {stage: LatencyHistogram() for stage in STAGES}
+        self.seconds = dict.fromkeys(STAGES, 0.0)
+        self.calls = dict.fromkeys(STAGES, 0)
+
+    def timed(self, stage, start):
+        """Account one call of stage that started at start"""
+        now = time.perf_counter()
+        self.seconds[stage] += now - start
+        self.histograms[stage].record(now - start)
+        self.calls[stage] += 1
+        return now
+
+
+def split_recording(records):
+    """Return the (frames, commands) records of a session in file order"""
+    return records[records['kind'] == KIND_FRAME], records[records['kind'] == KIND_COMMAND]
+
+
+def replay(frames, commands, classifier, options):
+    """Replay frames in batches of options.batch, then every recorded ramp step"""
+    result = Replay(len(frames), len(commands))
+    hand = (frames['flags'] & FLAG_HAND) != 0
+    class_id = NO_GESTURE
+    confidence = 0.0
+    position = STOP
+
+    for begin in range(0, len(frames), options.batch):
+        end = min(begin + options.batch, len(frames))
+        rows = np.flatnonzero(hand[begin:end]) + begin
+
+        start = time.perf_counter()
+        if len(rows):
+            result.features[rows] = preprocess_landmarks(
+                frames['landmarks'][rows], frames['image_size'][rows])
+        start = result.timed('preprocess', start)
+
+        if len(rows):
+            ids, outputs = classifier.classify(result.features[rows])
+            result.class_ids[rows] = ids
+            result.confidence[rows] = outputs[np.arange(len(rows)), ids]
+        start = result.timed('classify', start)
+
+        # Frames without a hand republish the last gesture, as the node does,
+        # and every published gesture may move the ramp to a new position
+        for i in range(begin, end):
+            if hand[i]:
+                class_id = result.class_ids[i]
+                confidence = result.confidence[i]
+            else:
+                result.class_ids[i] = class_id
+                result.confidence[i] = confidence
+            if int(class_id) in GESTURE_POSITIONS:
+                position = class_id
+            result.positions[i] = position
+        result.timed('gesture', start)
+
+    # Each step uses the position after the last gesture the ramp received
+    ramp = VelocityRamp(options.linear_vel_limit, options.angular_vel_limit,
+                        options.linear_vel_increment, options.angular_vel_increment,
+                        options.control_period)
+    frame_stamps = frames['capture_stamp']
+    for j in np.flatnonzero((commands['flags'] & FLAG_STEP) != 0):
+        start = time.perf_counter()
+        stamp = commands['capture_stamp'][j]
+        i = np.searchsorted(frame_stamps, stamp, side='right') - 1
+        position = result.positions[i] if stamp and i >= 0 else STOP
+        dt = commands['dt'][j] if commands['flags'][j] & FLAG_SCALED else None
+        result.twist[j] = ramp.step(GESTURE_POSITIONS[int(position)], dt)
+        result.command_positions[j] = position
+        result.timed('ramp', start)
+    return result
+
+
+def report_timing(result, frame_count, batch):
+    """Print throughput and the latency distribution of each stage"""
+    total = sum(result.seconds.values())
+    if not total:
+        return
+    print(f'  throughput {frame_count / total:.0f} frames/s ({total * 1e3:.1f} ms)')
+    for stage in STAGES:
+        calls = result.calls[stage]
+        if not calls:
+            continue
+        counts, _ = result.histograms[stage].snapshot()
+        seconds = result.seconds[stage]
+        if stage in BATCH_STAGES:
+            rate = f'{frame_count / seconds:10.0f} frames/s'
+            unit = f'per batch of <={batch} frames ({calls} batches)'
+        else:
+            rate = f'{calls / seconds:10.0f} steps/s '
+            unit = f'per step ({calls} steps)'
+        print(f'  {stage:<10} {rate}  {unit} '
+              f'mean={seconds / calls * 1e6:.2f}us '
+              f'p50={LatencyHistogram.percentile(counts, 0.5) * 1e6:.2f}us '
+              f'p99={LatencyHistogram.percentile(counts, 0.99) * 1e6:.2f}us '
+              f'max={LatencyHistogram.percentile(counts, 1.0) * 1e6:.2f}us')
+
+
+def report_diffs(frames, commands, result, options):
+    """Print where the replay disagrees with the recording; return the diff count"""
+    hand = (frames['flags'] & FLAG_HAND) != 0
+    steps = (commands['flags'] & FLAG_STEP) != 0
+
+    feature_error = np.abs(result.features[hand] - frames['features'][hand]).max(axis=1) \
+        if hand.any() else np.zeros(0)
+    feature_diffs = int(np.count_nonzero(feature_error > options.feature_tolerance))
+    class_diffs = np.flatnonzero(result.class_ids != frames['class_id'])
+    confidence_error = np.abs(result.confidence - frames['confidence'])
+    position_diffs = np.flatnonzero(steps & (result.command_positions != commands['class_id']))
+    twist_error = np.abs(result.twist - commands['twist']).max(axis=1) \
+        if len(commands) else np.zeros(0)
+    twist_diffs = np.flatnonzero(steps & (twist_error > options.twist_tolerance))
+
+    print(f'  {len(frames)} frames, {int(hand.sum())} with a hand; '
+          f'{int(steps.sum())} ramp steps replayed')
+    if len(commands) > steps.sum():
+        print(f'  {len(commands) - int(steps.sum())} commands from cmd_vel_stamped have no '
+              f'step timeline (split setup) and are not replayed')
+    print(f'  features   {feature_diffs} differ '
+          f'(max |diff| {feature_error.max() if len(feature_error) else 0.0:.3g})')
+    print(f'  gestures   {len(class_diffs)} differ '
+          f'(max confidence |diff| {confidence_error.max() if len(frames) else 0.0:.3g})')
+    print(f'  positions  {len(position_diffs)} differ')
+    print(f'  commands   {len(twist_diffs)} differ beyond {options.twist_tolerance:g} '
+          f'(max |diff| {twist_error[steps].max() if steps.any() else 0.0:.3g})')
+
+    for i in class_diffs[:options.show_diffs]:
+        print(f'    gesture diff at frame {i} (seq {frames["seq"][i]}): '
+              f'recorded {frames["class_id"][i]}, replayed {result.class_ids[i]}')
+    first_step = commands['step_stamp'][steps][0] if steps.any() else 0
+    for j in np.union1d(position_diffs, twist_diffs)[:options.show_diffs]:
+        print(f'    command diff at step {j} '
+              f'(t={(commands["step_stamp"][j] - first_step) * 1e-9:.3f}s): '
+              f'recorded {commands["class_id"][j]} '
+              f'({commands["twist"][j][0]:+.4f}, {commands["twist"][j][1]:+.4f}), '
+              f'replayed {result.command_positions[j]} '
+              f'({result.twist[j][0]:+.4f}, {result.twist[j][1]:+.4f})')
+    return feature_diffs + len(class_diffs) + len(position_diffs) + len(twist_diffs)
+
+
+def main(args=None):
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('recordings', nargs='+', help='files written via record_file')
+    parser.add_argument('--model', help='keypoint_classifier.tflite path')
+    parser.add_argument('--backend', choices=['engine', 'numpy'], default='engine')
+    parser.add_argument('--batch', type=int, default=64, help='frames per batch')
+    parser.add_argument('--repeat', type=int, default=3,
+                        help='passes per recording; timing of the fastest is shown')
+    parser.add_argument('--linear-vel-limit', type=float, default=LINEAR_VEL_LIMIT)
+    parser.add_argument('--angular-vel-limit', type=float, default=ANGULAR_VEL_LIMIT)
+    parser.add_argument('--linear-vel-increment', type=float, default=LINEAR_VEL_INCREMENT)
+    parser.add_argument('--angular-vel-increment', type=float, default=ANGULAR_VEL_INCREMENT)
+    parser.add_argument('--control-period', type=float, default=CONTROL_PERIOD)
+    parser.add_argument('--feature-tolerance', type=float, default=1e-6)
+    parser.add_argument('--twist-tolerance', type=float, default=1e-9)
+    parser.add_argument('--show-diffs', type=int, default=5,
+                        help='diffs to list per kind')
+    parser.add_argument('--fail-on-diff', action='store_true',
+                        help='exit non-zero if any replayed decision differs')
+    options = parser.parse_args(args)
+
+    model_path = options.model or default_model_path()
+    classifier = KeypointClassifier(model_path, max_batch=options.batch,
+                                    use_native=options.backend == 'engine')
+    print(f'classifier {classifier.backend}, batch {options.batch}')
+
+    diffs = 0
+    for path in options.recordings:
+        sessions = split_sessions(load_recording(path))
+        print(f'\n{path}: {len(sessions)} sessions')
+        for index, session in enumerate(sessions):
+            frames, commands = split_recording(session)
+            print(f'session {index}: {len(frames)} frames, {len(commands)} commands')
+            if len(frames):
+                duration = (frames['capture_stamp'][-1] - frames['capture_stamp'][0]) * 1e-9
+                print(f'  recorded {duration:.1f} s, '
+                      f'{len(frames) / max(duration, 1e-9):.1f} frames/s')
+
+            results = [replay(frames, commands, classifier, options)
+                       for _ in range(max(1, options.repeat))]
+            report_timing(min(results, key=lambda r: sum(r.seconds.values())),
+                          len(frames), options.batch)
+            diffs += report_diffs(frames, commands, results[0], options)
+    return 1 if options.fail_on_diff and diffs else 0
+
+
+if __name__ == '__main__':
+    raise SystemExit(main())
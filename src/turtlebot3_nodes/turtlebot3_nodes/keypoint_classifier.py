@@ -0,0 +1,206 @@
+#!/usr/bin/env python3
+
+"""Keypoint classifier that runs the TFLite MLP without the interpreter.
+
+The dense layers are read straight out of the .tflite flatbuffer once, then
+executed by the native engine (turtlebot3_nodes._keypoint_engine) or, if the
+extension is not built, by numpy into preallocated buffers.
+"""
+
+import struct
+
+import numpy as np
+
+ACTIVATION_NONE = 0
+ACTIVATION_RELU = 1
+
+# TFLite schema enums used by the keypoint classifier
+_TENSOR_FLOAT32 = 0
+_OP_FULLY_CONNECTED = 9
+_OP_SOFTMAX = 25
+_FUSED_ACTIVATIONS = {0: ACTIVATION_NONE, 1: ACTIVATION_RELU}
+
+
+class _Table:
+    """Minimal read-only view of a flatbuffer table."""
+
+    def __init__(self, data, pos):
+        self.data = data
+        self.pos = pos
+        self.vtable = pos - struct.unpack_from('<i', data, pos)[0]
+        self.vtable_size = struct.unpack_from('<H', data, self.vtable)[0]
+
+    def _field(self, index):
+        entry = 4 + 2 * index
+        if entry >= self.vtable_size:
+            return 0
+        return struct.unpack_from('<H', self.data, self.vtable + entry)[0]
+
+    def _target(self, index):
+        offset = self._field(index)
+        if not offset:
+            return None
+        pos = self.pos + offset
+        return pos + struct.unpack_from('<I', self.data, pos)[0]
+
+    def scalar(self, index, fmt, default=0):
+        offset = self._field(index)
+        if not offset:
+            return default
+        return struct.unpack_from(fmt, self.data, self.pos + offset)[0]
+
+    def vector(self, index, fmt):
+        pos = self._target(index)
+        if pos is None:
+            return []
+        length = struct.unpack_from('<I', self.data, pos)[0]
+        return list(struct.unpack_from(f'<{length}{fmt}', self.data, pos + 4))
+
+    def raw(self, index):
+        pos = self._target(index)
+        if pos is None:
+            return b''
+        length = struct.unpack_from('<I', self.data, pos)[0]
+        return self.data[pos + 4:pos + 4 + length]
+
+    def table(self, index):
+        pos = self._target(index)
+        return None if pos is None else _Table(self.data, pos)
+
+    def tables(self, index):
+        pos = self._target(index)
+        if pos is None:
+            return []
+        length = struct.unpack_from('<I', self.data, pos)[0]
+        items = []
+        for i in range(length):
+            item = pos + 4 + 4 * i
+            items.append(_Table(self.data, item + struct.unpack_from('<I', self.data, item)[0]))
+        return items
+
+
+def load_dense_layers(model_path):
+    """Extract the dense layers of a float32 FULLY_CONNECTED/SOFTMAX model.
+
+    Returns (layers, softmax_beta) where layers is a list of
+    (weights[out, in], bias[out], activation) and softmax_beta is 0.0 if the
+    model ends without a softmax. Raises ValueError for any other graph.
+    """
+    with open(model_path, 'rb') as f:
+        data = f.read()
+    if data[4:8] != b'TFL3':
+        raise ValueError(f"{model_path} is not a TFLite model")
+
+    model = _Table(data, struct.unpack_from('<I', data, 0)[0])
+    # Newer converters store the opcode in builtin_code and leave the
+    # deprecated byte at 127, older ones only fill the byte
+    opcodes = [max(code.scalar(0, '<b'), code.scalar(3, '<i')) for code in model.tables(1)]
+    buffers = model.tables(4)
+    subgraph = model.tables(2)[0]
+    tensors = subgraph.tables(0)
+
+    def constant(index):
+        tensor = tensors[index]
+        if tensor.scalar(1, '<b') != _TENSOR_FLOAT32:
+            raise ValueError(f"tensor {index} is not float32")
+        shape = tensor.vector(0, 'i')
+        values = np.frombuffer(buffers[tensor.scalar(2, '<I')].raw(0), dtype='<f4')
+        return values.astype(np.float32).reshape(shape)
+
+    layers = []
+    softmax_beta = 0.0
+    current = subgraph.vector(1, 'i')[0]
+    for op in subgraph.tables(3):
+        code = opcodes[op.scalar(0, '<I')]
+        inputs, outputs = op.vector(1, 'i'), op.vector(2, 'i')
+        if inputs[0] != current or softmax_beta:
+            raise ValueError("only a single chain of dense layers is supported")
+        options = op.table(4)
+        if code == _OP_FULLY_CONNECTED:
+            activation = options.scalar(0, '<b') if options else 0
+            if activation not in _FUSED_ACTIVATIONS:
+                raise ValueError(f"unsupported fused activation {activation}")
+            weights = constant(inputs[1])
+            bias = constant(inputs[2]) if len(inputs) > 2 and inputs[2] >= 0 \
+                else np.zeros(weights.shape[0], dtype=np.float32)
+            layers.append((weights, bias, _FUSED_ACTIVATIONS[activation]))
+        elif code == _OP_SOFTMAX:
+            softmax_beta = options.scalar(0, '<f', 1.0) if options else 1.0
+        else:
+            raise ValueError(f"unsupported operator {code}")
+        current = outputs[0]
+    if not layers:
+        raise ValueError(f"{model_path} has no dense layers")
+    return layers, softmax_beta
+
+
+class KeypointClassifier:
+    """Batched classifier for preprocessed 42-float landmark vectors."""
+
+    def __init__(self, model_path, max_batch=8, use_native=True):
+        self.layers, self.softmax_beta = load_dense_layers(model_path)
+        self.input_size = self.layers[0][0].shape[1]
+        self.num_classes = self.layers[-1][0].shape[0]
+
+        self.engine = None
+        if use_native:
+            try:
+                from turtlebot3_nodes import _keypoint_engine
+                self.engine = _keypoint_engine.Engine(self.layers, self.softmax_beta)
+                self.backend = f'native-{_keypoint_engine.SIMD}'
+            except ImportError:
+                pass
+        if self.engine is None:
+            self.backend = 'numpy'
+        self._allocate(max_batch)
+
+    def _allocate(self, max_batch):
+        self.max_batch = max_batch
+        self.inputs = np.zeros((max_batch, self.input_size), dtype=np.float32)
+        self.outputs = np.zeros((max_batch, self.num_classes), dtype=np.float32)
+        self.class_ids = np.zeros(max_batch, dtype=np.int32)
+        # Per-layer activations for the numpy path
+        self._activations = [
+            np.zeros((max_batch, weights.shape[0]), dtype=np.float32)
+            for weights, _, _ in self.layers]
+
+    def classify(self, inputs):
+        """Classify a (count, input_size) float32 array.
+
+        Returns (class_ids, outputs) as views into buffers owned by the
+        classifier; they are overwritten by the next call.
+        """
+        count = len(inputs)
+        if count > self.max_batch:
+            self._allocate(count)
+        ids = self.class_ids[:count]
+        outputs = self.outputs[:count]
+        if self.engine is not None:
+            self.engine.run(inputs, outputs, ids)
+        else:
+            self._run_numpy(inputs, outputs, ids)
+        return ids, outputs
+
+    def __call__(self, landmark_vector):
+        """Classify one preprocessed landmark vector into (class_id, confidence)."""
+        self.inputs[0] = landmark_vector
+        ids, outputs = self.classify(self.inputs[:1])
+        class_id = int(ids[0])
+        return class_id, float(outputs[0, class_id])
+
+    def _run_numpy(self, inputs, outputs, ids):
+        x = inputs
+        for (weights, bias, activation), y in zip(self.layers, self._activations):
+            y = y[:len(inputs)]
+            np.dot(x, weights.T, out=y)
+            y += bias
+            if activation == ACTIVATION_RELU:
+                np.maximum(y, 0.0, out=y)
+            x = y
+        outputs[...] = x
+        if self.softmax_beta > 0.0:
+            outputs -= outputs.max(axis=1, keepdims=True)
+            outputs *= self.softmax_beta
+            np.exp(outputs, out=outputs)
+            outputs /= outputs.sum(axis=1, keepdims=True)
+        np.argmax(outputs, axis=1, out=ids)
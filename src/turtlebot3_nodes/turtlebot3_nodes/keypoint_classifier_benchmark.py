@@ -0,0 +1,176 @@
+#!/usr/bin/env python3
+
+"""Compare the keypoint classifier engine against the TFLite interpreter.
+
+Reports per-call latency for single-hand classification, batched throughput,
+and how closely the engine outputs agree with the interpreter on the same
+landmark vectors.
+"""
+
+import argparse
+import csv
+import os
+import time
+
+import numpy as np
+
+from turtlebot3_nodes.keypoint_classifier import KeypointClassifier
+
+
+def default_model_path():
+    """Return the installed classifier model"""
+    from ament_index_python.packages import get_package_share_directory
+    return os.path.join(get_package_share_directory('turtlebot3_nodes'),
+                        'model/keypoint_classifier/keypoint_classifier.tflite')
+
+
+def load_landmarks(path, input_size):
+    """Read preprocessed landmark vectors from a CSV file.
+
+    Accepts rows of input_size floats, optionally preceded by a label column
+    as in the keypoint training CSV.
+    """
+    rows = []
+    with open(path, encoding='utf-8-sig') as f:
+        for row in csv.reader(f):
+            if row:
+                rows.append([float(x) for x in row[-input_size:]])
+    return np.array(rows, dtype=np.float32)
+
+
+def synthetic_landmarks(count, input_size, seed=0):
+    """Generate wrist-relative, max-normalized vectors like pre_process_landmark"""
+    rng = np.random.default_rng(seed)
+    points = rng.integers(0, 480, size=(count, input_size // 2, 2))
+    relative = (points - points[:, :1, :]).reshape(count, input_size).astype(np.float32)
+    scale = np.abs(relative).max(axis=1, keepdims=True)
+    scale[scale == 0.0] = 1.0
+    return relative / scale
+
+
+def make_interpreter(model_path):
+    """Create the TFLite interpreter used by the original node, if available"""
+    try:
+        from tflite_runtime.interpreter import Interpreter
+    except ImportError:
+        try:
+            from tensorflow.lite import Interpreter
+        except ImportError:
+            return None
+    interpreter = Interpreter(model_path=model_path)
+    interpreter.allocate_tensors()
+    return interpreter
+
+
+def run_interpreter(interpreter, landmarks):
+    """Classify each row the way run_model_inference does"""
+    input_index = interpreter.get_input_details()[0]['index']
+    output_index = interpreter.get_output_details()[0]['index']
+    outputs = []
+    for row in landmarks:
+        interpreter.set_tensor(input_index, np.array([row], dtype=np.float32))
+        interpreter.invoke()
+        outputs.append(interpreter.get_tensor(output_index)[0])
+    return np.array(outputs, dtype=np.float32)
+
+
+def time_per_call(fn, landmarks, repeat):
+    """Return the mean seconds per call of fn(row) over every row"""
+    start = time.perf_counter()
+    for _ in range(repeat):
+        for row in landmarks:
+            fn(row)
+    return (time.perf_counter() - start) / (repeat * len(landmarks))
+
+
+def time_batched(classifier, landmarks, batch, repeat):
+    """Return rows/s of classifier.classify over batches of the given size"""
+    batches = [np.ascontiguousarray(landmarks[i:i + batch])
+               for i in range(0, len(landmarks), batch)]
+    start = time.perf_counter()
+    for _ in range(repeat):
+        for chunk in batches:
+            classifier.classify(chunk)
+    return repeat * len(landmarks) / (time.perf_counter() - start)
+
+
+def agreement(name, outputs, reference):
+    """Print max output difference and argmax mismatches against reference"""
+    diff = np.abs(outputs - reference).max()
+    mismatches = int(np.count_nonzero(outputs.argmax(axis=1) != reference.argmax(axis=1)))
+    exact = 'bit-exact' if np.array_equal(outputs, reference) else f'max |diff| {diff:.3g}'
+    print(f'  {name:<24} {exact}, argmax mismatches {mismatches}/{len(reference)}')
+    return mismatches
+
+
+def main(args=None):
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--model', help='keypoint_classifier.tflite path')
+    parser.add_argument('--landmarks', help='CSV of preprocessed landmark vectors')
+    parser.add_argument('--count', type=int, default=1000,
+                        help='synthetic vectors when --landmarks is not given')
+    parser.add_argument('--repeat', type=int, default=5)
+    parser.add_argument('--batch', type=int, nargs='+', default=[1, 8, 64])
+    parser.add_argument('--tolerance', type=float, default=1e-5,
+                        help='max allowed output difference against TFLite')
+    options = parser.parse_args(args)
+
+    model_path = options.model or default_model_path()
+    classifiers = [KeypointClassifier(model_path)]
+    if classifiers[0].engine is not None:
+        classifiers.append(KeypointClassifier(model_path, use_native=False))
+    input_size = classifiers[0].input_size
+
+    if options.landmarks:
+        landmarks = load_landmarks(options.landmarks, input_size)
+        source = options.landmarks
+    else:
+        landmarks = synthetic_landmarks(options.count, input_size)
+        source = 'synthetic'
+    print(f'{len(landmarks)} landmark vectors ({source}), model {model_path}')
+
+    interpreter = make_interpreter(model_path)
+    print('\nsingle-hand latency (us/call)')
+    if interpreter is not None:
+        input_index = interpreter.get_input_details()[0]['index']
+        output_index = interpreter.get_output_details()[0]['index']
+
+        def invoke(row):
+            interpreter.set_tensor(input_index, np.array([row], dtype=np.float32))
+            interpreter.invoke()
+            return np.argmax(interpreter.get_tensor(output_index)[0])
+
+        latency = time_per_call(invoke, landmarks, options.repeat)
+        print(f'  {"tflite":<24} {latency * 1e6:8.2f}')
+    else:
+        print('  tflite                   unavailable (no tflite_runtime or tensorflow)')
+    for classifier in classifiers:
+        latency = time_per_call(classifier, landmarks, options.repeat)
+        print(f'  {classifier.backend:<24} {latency * 1e6:8.2f}')
+
+    print('\nbatched throughput (rows/s)')
+    for classifier in classifiers:
+        for batch in options.batch:
+            rate = time_batched(classifier, landmarks, batch, options.repeat)
+            print(f'  {classifier.backend + f" batch={batch}":<24} {rate:12.0f}')
+
+    print('\nagreement')
+    failed = False
+    if interpreter is not None:
+        reference = run_interpreter(interpreter, landmarks)
+        reference_name = 'tflite'
+    else:
+        reference = None
+    for classifier in classifiers:
+        _, outputs = classifier.classify(landmarks)
+        outputs = outputs.copy()
+        if reference is None:
+            reference, reference_name = outputs, classifier.backend
+            continue
+        mismatches = agreement(f'{classifier.backend} vs {reference_name}', outputs, reference)
+        failed |= mismatches > 0 or np.abs(outputs - reference).max() > options.tolerance
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    raise SystemExit(main())
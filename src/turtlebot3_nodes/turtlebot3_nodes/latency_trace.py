@@ -0,0 +1,145 @@
+#!/usr/bin/env python3
+
+"""Per-stage latency tracing shared by the gesture control nodes.
+
+Each stage owns a log-scale histogram that only one thread writes to, so
+recording is a bucket index and an increment with no lock. A node timer
+snapshots all histograms, publishes the window's percentiles as JSON on a
+stats topic and optionally appends them to a file.
+"""
+
+import json
+import math
+import time
+
+from std_msgs.msg import String
+
+# Buckets are quarter octaves from 1 us, which covers up to ~16 s with a
+# relative error of about 19% per bucket
+_BUCKETS_PER_OCTAVE = 4
+_NUM_BUCKETS = 24 * _BUCKETS_PER_OCTAVE
+_MIN_SECONDS = 1e-6
+
+
+class LatencyHistogram:
+    """Single-writer log-scale histogram of durations in seconds."""
+
+    def __init__(self):
+        self.counts = [0] * _NUM_BUCKETS
+        self.total = 0.0
+
+    def record(self, seconds):
+        """Add one duration; must only be called from the owning thread."""
+        if seconds <= _MIN_SECONDS:
+            index = 0
+        else:
+            index = min(int(math.log2(seconds / _MIN_SECONDS) * _BUCKETS_PER_OCTAVE),
+                        _NUM_BUCKETS - 1)
+        self.counts[index] += 1
+        self.total += seconds
+
+    def snapshot(self):
+        """Copy the counters; readers may see a sample that is still in flight."""
+        return list(self.counts), self.total
+
+    @staticmethod
+    def bucket_upper_bound(index):
+        """Return the largest duration that falls into bucket index."""
+        return _MIN_SECONDS * 2.0 ** ((index + 1) / _BUCKETS_PER_OCTAVE)
+
+    @classmethod
+    def percentile(cls, counts, fraction):
+        """Return the bucket upper bound below which fraction of samples fall."""
+        n = sum(counts)
+        if n == 0:
+            return 0.0
+        rank = max(1, math.ceil(fraction * n))
+        seen = 0
+        for index, count in enumerate(counts):
+            seen += count
+            if seen >= rank:
+                return cls.bucket_upper_bound(index)
+        return cls.bucket_upper_bound(len(counts) - 1)
+
+
+class LatencyTracer:
+    """Stage histograms and event counters reported periodically by a node."""
+
+    def __init__(self, node, stages, period=5.0, topic='~/latency_stats', dump_path=''):
+        self.node = node
+        self.stages = list(stages)
+        self.histograms = {stage: LatencyHistogram() for stage in self.stages}
+        self.counters = {}
+        self._last = {stage: ([0] * _NUM_BUCKETS, 0.0) for stage in self.stages}
+        self._last_counters = {}
+        self._last_report = time.monotonic()
+        self._dump = open(dump_path, 'a', encoding='utf-8') if dump_path else None
+        self.publisher = node.create_publisher(String, topic, 10)
+        self.timer = node.create_timer(period, self.report) if period > 0.0 else None
+
+    def record(self, stage, seconds):
+        """Record a duration for stage."""
+        self.histograms[stage].record(seconds)
+
+    def record_since(self, stage, stamp):
+        """Record the age of a builtin_interfaces/Time stamp on the node clock."""
+        now = self.node.get_clock().now().nanoseconds
+        self.record(stage, (now - (stamp.sec * 1_000_000_000 + stamp.nanosec)) * 1e-9)
+
+    def count(self, name, n=1):
+        """Increment an event counter; each name must have a single writer."""
+        self.counters[name] = self.counters.get(name, 0) + n
+
+    def report(self):
+        """Publish and log the statistics of the window since the last report."""
+        now = time.monotonic()
+        elapsed = max(now - self._last_report, 1e-9)
+        self._last_report = now
+
+        stats = {'node': self.node.get_name(), 'window': elapsed, 'rates': {}, 'stages': {}}
+        for name, total in list(self.counters.items()):
+            stats['rates'][name] = (total - self._last_counters.get(name, 0)) / elapsed
+            self._last_counters[name] = total
+
+        for stage in self.stages:
+            counts, total = self.histograms[stage].snapshot()
+            last_counts, last_total = self._last[stage]
+            window = [c - p for c, p in zip(counts, last_counts)]
+            self._last[stage] = (counts, total)
+            n = sum(window)
+            if n == 0:
+                continue
+            stats['stages'][stage] = {
+                'count': n,
+                'mean': (total - last_total) / n,
+                'p50': LatencyHistogram.percentile(window, 0.50),
+                'p90': LatencyHistogram.percentile(window, 0.90),
+                'p99': LatencyHistogram.percentile(window, 0.99),
+                'max': LatencyHistogram.percentile(window, 1.0),
+            }
+
+        line = json.dumps(stats)
+        msg = String()
+        msg.data = line
+        self.publisher.publish(msg)
+        if self._dump is not None:
+            self._dump.write(line + '\n')
+            self._dump.flush()
+        self.node.get_logger().info(f"Latency {self.summary(stats)}")
+        return stats
+
+    @staticmethod
+    def summary(stats):
+        """Format a report as a single log line."""
+        rates = ' '.join(f'{name}={rate:.1f}/s' for name, rate in sorted(stats['rates'].items()))
+        stages = ' '.join(
+            f"{stage}[p50={s['p50'] * 1e3:.1f} p99={s['p99'] * 1e3:.1f} "
+            f"max={s['max'] * 1e3:.1f}]ms"
+            for stage, s in stats['stages'].items())
+        return f'{rates} | {stages}'
+
+    def close(self):
+        """Close the dump file."""
+        if self._dump is not None:
+            self._dump.close()
+            self._dump = None
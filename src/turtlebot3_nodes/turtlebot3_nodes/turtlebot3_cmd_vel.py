@@ -1,24 +1,64 @@
 #!/usr/bin/env python3
 
+import threading
+import time
+
 import rclpy
 from rclpy.node import Node
-from geometry_msgs.msg import Twist
-from std_msgs.msg import String
+from geometry_msgs.msg import Twist, TwistStamped
+from turtlebot3_gesture_msgs.msg import Gesture
+
+from turtlebot3_nodes.latency_trace import LatencyTracer
+from turtlebot3_nodes.velocity_ramp import (
+    ANGULAR_VEL_INCREMENT, ANGULAR_VEL_LIMIT, CONTROL_PERIOD,
+    LINEAR_VEL_INCREMENT, LINEAR_VEL_LIMIT, VelocityRamp)
 
-# Constants for velocity limits and increments
-LINEAR_VEL_LIMIT = 0.22  # m/s
-ANGULAR_VEL_LIMIT = 0.5  # rad/s
-LINEAR_VEL_INCREMENT = 0.05  # m/s
-ANGULAR_VEL_INCREMENT = 0.05  # rad/s
+# Gesture class ids mapped to the position commands handled by control_loop
+GESTURE_POSITIONS = {
+    Gesture.FORWARD: 'Forward',
+    Gesture.BACKWARD: 'Backward',
+    Gesture.LEFT: 'Left',
+    Gesture.RIGHT: 'Right',
+    Gesture.STOP: 'Stop',
+}
+POSITION_GESTURES = {position: class_id for class_id, position in GESTURE_POSITIONS.items()}
 
 class CmdVelPublisher(Node):
-    def __init__(self):
-        super().__init__('turtlebot3_cmd_vel')
-        
+    def __init__(self, subscribe=True, parameter_overrides=None, listeners=()):
+        """Create the node; with subscribe=False gestures are fed by direct calls.
+
+        listeners are called in-process with every published command as
+        (twist, position class id, last gesture stamp, step time, dt or None).
+        """
+        super().__init__('turtlebot3_cmd_vel', parameter_overrides=parameter_overrides)
+        self.listeners = list(listeners)
+
         # Initialize variables
         self.position = 'Stop'
-        self.linear_vel = 0.0
-        self.angular_vel = 0.0
+        self.ramp = VelocityRamp(
+            self.declare_parameter('linear_vel_limit', LINEAR_VEL_LIMIT).value,
+            self.declare_parameter('angular_vel_limit', ANGULAR_VEL_LIMIT).value,
+            self.declare_parameter('linear_vel_increment', LINEAR_VEL_INCREMENT).value,
+            self.declare_parameter('angular_vel_increment', ANGULAR_VEL_INCREMENT).value,
+            self.declare_parameter('control_period', CONTROL_PERIOD).value)
+        # Event-driven mode also steps the ramp on every gesture, scaled by
+        # the elapsed time, instead of only on the control timer
+        self.event_driven = self.declare_parameter('event_driven', False).value
+        self.last_step = time.monotonic()
+        # Gestures may arrive on another thread when fed directly
+        self.lock = threading.Lock()
+        # Capture stamp of the gesture that set the current position, and
+        # whether a command reflecting it has been published yet
+        self.position_stamp = None
+        self.position_pending = False
+        # Capture stamp of the last gesture received, whatever its position
+        self.gesture_stamp = None
+
+        stats_period = self.declare_parameter('stats_period', 5.0).value
+        trace_file = self.declare_parameter('trace_file', '').value
+        self.tracer = LatencyTracer(
+            self, ['gesture_transit', 'capture_to_cmd_vel'],
+            period=stats_period, dump_path=trace_file)
 
         # Create publisher for cmd_vel
         self.cmd_vel_publisher = self.create_publisher(
@@ -28,56 +68,82 @@ class CmdVelPublisher(Node):
         )
         self.get_logger().info("CMD_VEL publisher created!")
 
-        # Create subscription to chatter topic
-        self.subscription = self.create_subscription(
-            String,
-            "chatter",
-            self.listener_callback,
-            10
-        )
-        self.get_logger().info("Listening to chatter topic...")
+        # Optionally republish each command stamped with the capture time of
+        # the gesture behind it, for latency tracing further downstream
+        self.stamped_publisher = None
+        if self.declare_parameter('publish_stamped', False).value:
+            self.stamped_publisher = self.create_publisher(
+                TwistStamped,
+                "cmd_vel_stamped",
+                10
+            )
+
+        # Create subscription to gesture topic
+        if subscribe:
+            self.subscription = self.create_subscription(
+                Gesture,
+                "gesture",
+                self.listener_callback,
+                10
+            )
+            self.get_logger().info("Listening to gesture topic...")
 
         # Create timer for control loop
-        self.create_timer(0.1, self.control_loop)
+        self.create_timer(self.ramp.period, self.control_loop)
 
     def listener_callback(self, msg):
-        """Callback for processing incoming String messages."""
-        new_position = msg.data.strip()
-        if new_position != self.position:
-            self.get_logger().info(f"New position command: {new_position}")
-            self.position = new_position
+        """Callback for processing incoming Gesture messages."""
+        with self.lock:
+            self.tracer.record_since('gesture_transit', msg.header.stamp)
+            self.gesture_stamp = msg.header.stamp
+            new_position = GESTURE_POSITIONS.get(msg.class_id)
+            if new_position is not None and new_position != self.position:
+                self.get_logger().info(f"New position command: {new_position}")
+                self.position = new_position
+                self.position_stamp = msg.header.stamp
+                self.position_pending = True
+        if self.event_driven:
+            self.control_loop()
 
     def control_loop(self):
         """Main control loop that publishes velocity commands."""
         cmd_msg = Twist()
-        
-        # Handle position commands
-        if self.position == 'Forward':
-            self.linear_vel = min(self.linear_vel + LINEAR_VEL_INCREMENT, LINEAR_VEL_LIMIT)
-            self.angular_vel = 0.0
-        elif self.position == 'Backward':
-            self.linear_vel = max(self.linear_vel - LINEAR_VEL_INCREMENT, -LINEAR_VEL_LIMIT)
-            self.angular_vel = 0.0
-        elif self.position == 'Left':
-            self.angular_vel = min(self.angular_vel + ANGULAR_VEL_INCREMENT, ANGULAR_VEL_LIMIT)
-            self.linear_vel = 0.0
-        elif self.position == 'Right':
-            self.angular_vel = max(self.angular_vel - ANGULAR_VEL_INCREMENT, -ANGULAR_VEL_LIMIT)
-            self.linear_vel = 0.0
-        elif self.position == 'Stop':
-            self.linear_vel = 0.0
-            self.angular_vel = 0.0
-
-        # Set velocity values
-        cmd_msg.linear.x = self.linear_vel
-        cmd_msg.angular.z = self.angular_vel  # Fixed: Changed from angular.x to angular.z
-
-        # Publish command
-        self.cmd_vel_publisher.publish(cmd_msg)
+
+        with self.lock:
+            # Handle position commands
+            now = time.monotonic()
+            dt = None
+            if self.event_driven:
+                dt = min(now - self.last_step, self.ramp.period)
+                self.last_step = now
+            linear_vel, angular_vel = self.ramp.step(self.position, dt)
+
+            # Set velocity values
+            cmd_msg.linear.x = linear_vel
+            cmd_msg.angular.z = angular_vel  # Fixed: Changed from angular.x to angular.z
+
+            # Publish command
+            self.cmd_vel_publisher.publish(cmd_msg)
+            if self.position_pending:
+                self.tracer.record_since('capture_to_cmd_vel', self.position_stamp)
+                self.position_pending = False
+            if self.stamped_publisher is not None and self.position_stamp is not None:
+                stamped_msg = TwistStamped()
+                stamped_msg.header.stamp = self.position_stamp
+                stamped_msg.twist = cmd_msg
+                self.stamped_publisher.publish(stamped_msg)
+            for listener in self.listeners:
+                listener(cmd_msg, POSITION_GESTURES[self.position], self.gesture_stamp,
+                         now, dt)
         self.get_logger().debug(
-            f"Publishing - Linear: {self.linear_vel:.2f} m/s, Angular: {self.angular_vel:.2f} rad/s"
+            f"Publishing - Linear: {linear_vel:.2f} m/s, Angular: {angular_vel:.2f} rad/s"
         )
 
+    def stop(self):
+        """Publish a zero command to stop the robot"""
+        with self.lock:
+            self.cmd_vel_publisher.publish(Twist())
+
 def main(args=None):
     rclpy.init(args=args)
     cmd_vel_publisher = CmdVelPublisher()
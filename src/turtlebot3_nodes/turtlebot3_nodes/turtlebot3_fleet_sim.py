@@ -0,0 +1,282 @@
+#!/usr/bin/env python3
+
+"""Headless kinematic simulation of a TurtleBot3 fleet in one process.
+
+Every robot gets its own namespace with cmd_vel, odom and joint_states, like
+turtlebot3_fake_node. The state is kept as arrays with one entry per robot,
+and the whole fleet is integrated in a single vectorized step. The node
+publishes /clock, so nodes started with use_sim_time follow the fleet at any
+real-time factor. In lockstep mode the simulation also waits for every robot
+to be commanded before it moves on.
+"""
+
+import threading
+import time
+
+import numpy as np
+import rclpy
+from rclpy.executors import ExternalShutdownException
+from rclpy.node import Node
+from builtin_interfaces.msg import Time
+from geometry_msgs.msg import Twist
+from nav_msgs.msg import Odometry
+from rosgraph_msgs.msg import Clock
+from sensor_msgs.msg import JointState
+
+from turtlebot3_nodes.latency_trace import LatencyTracer
+
+# TurtleBot3 Burger geometry, as used by turtlebot3_fake_node
+WHEEL_SEPARATION = 0.160  # m
+WHEEL_RADIUS = 0.033  # m
+
+
+class FleetState:
+    """Structure-of-arrays pose, velocity and wheel state of a fleet."""
+
+    def __init__(self, count):
+        self.count = count
+        self.x = np.zeros(count)
+        self.y = np.zeros(count)
+        self.theta = np.zeros(count)
+        self.linear = np.zeros(count)
+        self.angular = np.zeros(count)
+        self.left_wheel = np.zeros(count)
+        self.right_wheel = np.zeros(count)
+        self.left_wheel_velocity = np.zeros(count)
+        self.right_wheel_velocity = np.zeros(count)
+        # Latest command per robot and the sim time it arrived
+        self.cmd_linear = np.zeros(count)
+        self.cmd_angular = np.zeros(count)
+        self.cmd_time = np.full(count, -np.inf)
+        # Scratch buffers so a step does not allocate
+        self._active = np.zeros(count, dtype=bool)
+        self._delta = np.zeros(count)
+        self._heading = np.zeros(count)
+        self._trig = np.zeros(count)
+
+    def step(self, dt, now, cmd_timeout):
+        """Integrate every robot over dt seconds of sim time ending at now."""
+        # Robots whose command is older than cmd_timeout stop
+        np.subtract(now, self.cmd_time, out=self._heading)
+        np.less_equal(self._heading, cmd_timeout, out=self._active)
+        self.linear.fill(0.0)
+        self.angular.fill(0.0)
+        np.copyto(self.linear, self.cmd_linear, where=self._active)
+        np.copyto(self.angular, self.cmd_angular, where=self._active)
+
+        # Midpoint heading integration of the unicycle model
+        np.multiply(self.angular, dt, out=self._delta)
+        np.multiply(self._delta, 0.5, out=self._heading)
+        self._heading += self.theta
+        np.cos(self._heading, out=self._trig)
+        self._trig *= self.linear
+        self._trig *= dt
+        self.x += self._trig
+        np.sin(self._heading, out=self._trig)
+        self._trig *= self.linear
+        self._trig *= dt
+        self.y += self._trig
+        self.theta += self._delta
+
+        # Wheel speeds and angles from the differential drive kinematics
+        np.multiply(self.angular, 0.5 * WHEEL_SEPARATION, out=self._trig)
+        np.subtract(self.linear, self._trig, out=self.left_wheel_velocity)
+        self.left_wheel_velocity *= 1.0 / WHEEL_RADIUS
+        np.add(self.linear, self._trig, out=self.right_wheel_velocity)
+        self.right_wheel_velocity *= 1.0 / WHEEL_RADIUS
+        np.multiply(self.left_wheel_velocity, dt, out=self._trig)
+        self.left_wheel += self._trig
+        np.multiply(self.right_wheel_velocity, dt, out=self._trig)
+        self.right_wheel += self._trig
+
+
+def to_time_msg(seconds):
+    """Convert float seconds to builtin_interfaces/Time"""
+    msg = Time()
+    msg.sec, msg.nanosec = divmod(int(round(seconds * 1e9)), 1_000_000_000)
+    return msg
+
+
+class FleetSim(Node):
+    def __init__(self):
+        super().__init__('turtlebot3_fleet_sim')
+
+        self.num_robots = self.declare_parameter('num_robots', 10).value
+        self.namespace_prefix = self.declare_parameter('namespace_prefix', 'robot').value
+        self.step_period = self.declare_parameter('step_period', 0.01).value
+        # <= 0 runs as fast as possible
+        self.real_time_factor = self.declare_parameter('real_time_factor', 1.0).value
+        # 0 disables odom/joint_states output for pure stepping throughput
+        self.publish_period = self.declare_parameter('publish_period', 0.05).value
+        self.cmd_vel_timeout = self.declare_parameter('cmd_vel_timeout', 1.0).value
+        self.lockstep = self.declare_parameter('lockstep', False).value
+        self.lockstep_timeout = self.declare_parameter('lockstep_timeout', 1.0).value
+        # Sim seconds to run before shutting down, 0 runs forever
+        self.duration = self.declare_parameter('duration', 0.0).value
+        stats_period = self.declare_parameter('stats_period', 5.0).value
+        if self.lockstep and self.publish_period <= 0.0:
+            # Lockstep waits for the commands that answer each odom publish
+            self.get_logger().error("lockstep requires publish_period > 0")
+            raise ValueError("lockstep requires publish_period > 0")
+
+        self.fleet = FleetState(self.num_robots)
+        self.tracer = LatencyTracer(self, ['step', 'publish', 'lockstep_wait'],
+                                    period=stats_period)
+        self.clock_publisher = self.create_publisher(Clock, '/clock', 10)
+
+        # Commands received since each robot's last published state
+        self.cmd_counts = np.zeros(self.num_robots, dtype=np.int64)
+        self.cmd_cond = threading.Condition()
+        self.sim_time = 0.0
+
+        self.namespaces = []
+        self.odom_publishers = []
+        self.joint_publishers = []
+        self.odom_msgs = []
+        self.joint_msgs = []
+        for i in range(self.num_robots):
+            namespace = f'{self.namespace_prefix}_{i}'
+            self.namespaces.append(namespace)
+            self.create_subscription(
+                Twist, f'/{namespace}/cmd_vel',
+                lambda msg, index=i: self.cmd_vel_callback(index, msg), 10)
+            self.odom_publishers.append(
+                self.create_publisher(Odometry, f'/{namespace}/odom', 10))
+            self.joint_publishers.append(
+                self.create_publisher(JointState, f'/{namespace}/joint_states', 10))
+
+            # Messages are reused every cycle; publish() serializes immediately
+            odom = Odometry()
+            odom.header.frame_id = f'{namespace}/odom'
+            odom.child_frame_id = f'{namespace}/base_footprint'
+            self.odom_msgs.append(odom)
+            joints = JointState()
+            joints.name = ['wheel_left_joint', 'wheel_right_joint']
+            joints.position = [0.0, 0.0]
+            joints.velocity = [0.0, 0.0]
+            self.joint_msgs.append(joints)
+
+        self.running = True
+        self.thread = threading.Thread(target=self.run, name='fleet_sim', daemon=True)
+        self.thread.start()
+        self.get_logger().info(
+            f"Simulating {self.num_robots} robots at {self.step_period * 1e3:.1f} ms steps, "
+            f"real time factor {self.real_time_factor if self.real_time_factor > 0 else 'max'}"
+            f"{', lockstep' if self.lockstep else ''}")
+
+    def cmd_vel_callback(self, index, msg):
+        """Store the latest command of robot index"""
+        self.fleet.cmd_linear[index] = msg.linear.x
+        self.fleet.cmd_angular[index] = msg.angular.z
+        self.fleet.cmd_time[index] = self.sim_time
+        if self.lockstep:
+            with self.cmd_cond:
+                self.cmd_counts[index] += 1
+                self.cmd_cond.notify()
+
+    def run(self):
+        """Step the fleet until shutdown or the configured duration"""
+        steps_per_publish = max(1, round(self.publish_period / self.step_period)) \
+            if self.publish_period > 0.0 else 0
+        wall_start = time.monotonic()
+        step = 0
+        while self.running and rclpy.ok():
+            start = time.monotonic()
+            # Commands time out against the sim time the step ends at
+            end_time = (step + 1) * self.step_period
+            self.fleet.step(self.step_period, end_time, self.cmd_vel_timeout)
+            step += 1
+            self.sim_time = end_time
+            stepped = time.monotonic()
+            self.tracer.record('step', stepped - start)
+            self.tracer.count('robot_steps', self.num_robots)
+            self.tracer.count('sim_seconds', self.step_period)
+
+            clock = Clock()
+            clock.clock = to_time_msg(self.sim_time)
+            self.clock_publisher.publish(clock)
+
+            if steps_per_publish and step % steps_per_publish == 0:
+                self.publish_state(clock.clock)
+                published = time.monotonic()
+                self.tracer.record('publish', published - stepped)
+                if self.lockstep:
+                    self.wait_for_commands()
+                    self.tracer.record('lockstep_wait', time.monotonic() - published)
+
+            if self.duration > 0.0 and self.sim_time >= self.duration:
+                elapsed = time.monotonic() - wall_start
+                self.get_logger().info(
+                    f"Finished {step} steps of {self.num_robots} robots in {elapsed:.2f} s: "
+                    f"{step * self.num_robots / elapsed:.0f} robot-steps/s, "
+                    f"real time factor {self.sim_time / elapsed:.1f}")
+                self.running = False
+                rclpy.shutdown()
+                break
+
+            if self.real_time_factor > 0.0:
+                delay = wall_start + self.sim_time / self.real_time_factor - time.monotonic()
+                if delay > 0.0:
+                    time.sleep(delay)
+
+    def publish_state(self, stamp):
+        """Publish odom and joint_states of every robot"""
+        fleet = self.fleet
+        half_theta = fleet.theta * 0.5
+        qz, qw = np.sin(half_theta), np.cos(half_theta)
+        for i in range(self.num_robots):
+            odom = self.odom_msgs[i]
+            odom.header.stamp = stamp
+            odom.pose.pose.position.x = float(fleet.x[i])
+            odom.pose.pose.position.y = float(fleet.y[i])
+            odom.pose.pose.orientation.z = float(qz[i])
+            odom.pose.pose.orientation.w = float(qw[i])
+            odom.twist.twist.linear.x = float(fleet.linear[i])
+            odom.twist.twist.angular.z = float(fleet.angular[i])
+            self.odom_publishers[i].publish(odom)
+
+            joints = self.joint_msgs[i]
+            joints.header.stamp = stamp
+            joints.position[0] = float(fleet.left_wheel[i])
+            joints.position[1] = float(fleet.right_wheel[i])
+            joints.velocity[0] = float(fleet.left_wheel_velocity[i])
+            joints.velocity[1] = float(fleet.right_wheel_velocity[i])
+            self.joint_publishers[i].publish(joints)
+
+    def wait_for_commands(self):
+        """Block until every robot has been commanded since the last publish"""
+        deadline = time.monotonic() + self.lockstep_timeout
+        with self.cmd_cond:
+            while self.running and not np.all(self.cmd_counts > 0):
+                remaining = deadline - time.monotonic()
+                if remaining <= 0.0:
+                    self.tracer.count('lockstep_timeouts')
+                    break
+                self.cmd_cond.wait(remaining)
+            self.cmd_counts[:] = 0
+
+    def stop(self):
+        """Stop the simulation thread"""
+        self.running = False
+        with self.cmd_cond:
+            self.cmd_cond.notify_all()
+        self.thread.join(timeout=1.0)
+
+
+def main(args=None):
+    rclpy.init(args=args)
+    node = FleetSim()
+    try:
+        rclpy.spin(node)
+    except (KeyboardInterrupt, ExternalShutdownException):
+        # A finished duration run shuts rclpy down from the sim thread
+        pass
+    finally:
+        node.stop()
+        node.destroy_node()
+        if rclpy.ok():
+            rclpy.shutdown()
+
+
+if __name__ == '__main__':
+    main()
@@ -3,29 +3,75 @@
 import rclpy
 from rclpy.node import Node
 from std_msgs.msg import String
+from geometry_msgs.msg import TwistStamped
+from turtlebot3_gesture_msgs.msg import Gesture
 import cv2
 import numpy as np
-import tensorflow as tf
 import mediapipe as mp
-import itertools
 import copy
 import csv
+import threading
+import time
 from ament_index_python.packages import get_package_share_directory
 import os
 
+from turtlebot3_nodes.gesture_pipeline import (
+    Frame, LatestSlot, calc_landmark_list, pre_process_landmark)
+from turtlebot3_nodes.gesture_recording import GestureRecorder, stamp_to_ns
+from turtlebot3_nodes.keypoint_classifier import KeypointClassifier
+from turtlebot3_nodes.latency_trace import LatencyTracer
+
 class GesturePublisher(Node):
-    def __init__(self):
+    def __init__(self, listeners=(), shutdown_hooks=()):
+        """Create the node; listeners are called in-process with every Gesture.
+
+        shutdown_hooks are called before the node shuts rclpy down on 'q',
+        while publishers can still be used.
+        """
         super().__init__("turtlebot3_gesture_publisher")
-        
-        # ROS 2 Publisher
+        self.listeners = list(listeners)
+        self.shutdown_hooks = list(shutdown_hooks)
+
+        # ROS 2 Publishers: typed, capture-stamped gestures plus the plain
+        # label on chatter for existing listeners
+        self.gesture_msg_publisher = self.create_publisher(Gesture, "gesture", 10)
         self.gesture_publisher = self.create_publisher(String, "chatter", 10)
         self.get_logger().info("Gesture recognition publisher initialized!")
         self.pkg_path = get_package_share_directory('turtlebot3_nodes')
+
+        # Pipelined mode runs capture, recognition and display on their own
+        # threads; otherwise fall back to polling the camera at 10Hz
+        self.use_pipeline = self.declare_parameter('use_pipeline', True).value
+        self.display = self.declare_parameter('display', True).value
+        self.camera_fps = self.declare_parameter('camera_fps', 30.0).value
+        self.stats_period = self.declare_parameter('stats_period', 5.0).value
+        self.trace_file = self.declare_parameter('trace_file', '').value
+        # 'engine' runs the dense layers natively, 'tflite' uses the interpreter
+        self.classifier_backend = self.declare_parameter('classifier_backend', 'engine').value
+
         # Initialize gesture recognition components
         self.initialize_gesture_recognition()
-        
-        # Run recognition on timer (10Hz)
-        self.timer = self.create_timer(0.1, self.run_gesture_recognition)
+        self.tracer = LatencyTracer(
+            self, ['queue', 'recognize', 'publish', 'capture_to_publish'],
+            period=self.stats_period, dump_path=self.trace_file)
+
+        # Optionally record every processed frame for offline replay
+        self.recorder = None
+        record_file = self.declare_parameter('record_file', '').value
+        if record_file:
+            self.recorder = GestureRecorder(record_file)
+            # A composed ramp records its steps through recorder.on_command;
+            # a separate turtlebot3_cmd_vel needs publish_stamped:=true
+            if not self.listeners:
+                self.create_subscription(
+                    TwistStamped, "cmd_vel_stamped", self.command_callback, 10)
+            self.get_logger().info(f"Recording frames to {record_file}")
+
+        if self.use_pipeline:
+            self.start_pipeline()
+        else:
+            # Run recognition on timer (10Hz)
+            self.timer = self.create_timer(0.1, self.run_gesture_recognition)
 
     def initialize_gesture_recognition(self):
         """Initialize MediaPipe and TFLite model"""
@@ -42,10 +88,15 @@ class GesturePublisher(Node):
         self.model_path = os.path.join(self.pkg_path, 'model/keypoint_classifier/keypoint_classifier.tflite')
         label_path = os.path.join(self.pkg_path, 'model/keypoint_classifier/keypoint_classifier_label.csv')
 
-        self.interpreter = tf.lite.Interpreter(model_path=self.model_path)
-        self.interpreter.allocate_tensors()
-        self.input_details = self.interpreter.get_input_details()
-        self.output_details = self.interpreter.get_output_details()
+        if self.classifier_backend == 'tflite':
+            import tensorflow as tf
+            self.interpreter = tf.lite.Interpreter(model_path=self.model_path)
+            self.interpreter.allocate_tensors()
+            self.input_details = self.interpreter.get_input_details()
+            self.output_details = self.interpreter.get_output_details()
+        else:
+            self.classifier = KeypointClassifier(self.model_path)
+            self.get_logger().info(f"Keypoint classifier backend: {self.classifier.backend}")
         
         # Load gesture labels
         with open(label_path , encoding='utf-8-sig') as f:
@@ -56,86 +107,232 @@ class GesturePublisher(Node):
         if not self.cap.isOpened():
             self.get_logger().error("Cannot open camera!")
             raise RuntimeError("Camera initialization failed")
-            
+        if self.use_pipeline:
+            # Keep the driver queue short so reads return the newest frame
+            self.cap.set(cv2.CAP_PROP_FPS, self.camera_fps)
+            self.cap.set(cv2.CAP_PROP_BUFFERSIZE, 1)
+
         self.current_gesture = "none"  # Default gesture
-    
+        self.current_class_id = Gesture.NONE
+        self.current_confidence = 0.0
+        self.current_features = None
+
     def run_gesture_recognition(self):
         """Main recognition loop"""
         ret, frame = self.cap.read()
         if not ret:
             self.get_logger().warn("Failed to capture frame")
             return
-            
+        captured = time.monotonic()
+        capture_stamp = self.get_clock().now().to_msg()
+
+        frame, hand_landmarks = self.recognize(frame)
+        if hand_landmarks is not None:
+            self.annotate(frame, hand_landmarks, self.current_gesture)
+        recognized = time.monotonic()
+
+        # Publish the detected gesture
+        self.publish_gesture(capture_stamp)
+        published = time.monotonic()
+        if self.recorder is not None:
+            self.record_frame(capture_stamp, self.recorder.frames, frame, hand_landmarks)
+        self.tracer.record('recognize', recognized - captured)
+        self.tracer.record('publish', published - recognized)
+        self.tracer.record('capture_to_publish', published - captured)
+        self.get_logger().info(f'Publishing: {self.current_gesture}')
+
+        # Display frame (optional)
+        if self.display:
+            self.show_frame(frame)
+
+    def recognize(self, frame):
+        """Run MediaPipe and the classifier on a BGR frame.
+
+        Updates the current gesture and returns the mirrored frame together with
+        the landmarks of the last detected hand (None if no hand was found).
+        """
         # Mirror and convert to RGB
         frame = cv2.flip(frame, 1)
         rgb_frame = cv2.cvtColor(frame, cv2.COLOR_BGR2RGB)
-        
+
         # Process with MediaPipe
         results = self.hands.process(rgb_frame)
-        
+
+        hand_landmarks = None
         if results.multi_hand_landmarks:
             for hand_landmarks in results.multi_hand_landmarks:
                 # Process landmarks
                 landmark_list = self.calc_landmark_list(frame, hand_landmarks)
                 pre_processed_landmark_list = self.pre_process_landmark(landmark_list)
-                
+                self.current_features = pre_processed_landmark_list
+
                 # Run model inference
-                gesture_id = self.run_model_inference(pre_processed_landmark_list)
+                gesture_id, confidence = self.run_model_inference(pre_processed_landmark_list)
                 self.current_gesture = self.gesture_classes[gesture_id]
-                
-                # Draw landmarks (optional)
-                mp.solutions.drawing_utils.draw_landmarks(
-                    frame, hand_landmarks, self.mp_hands.HAND_CONNECTIONS)
-                
-                # Display gesture
-                cv2.putText(frame, f"Gesture: {self.current_gesture}", (10, 50),
-                           cv2.FONT_HERSHEY_SIMPLEX, 1, (0, 255, 0), 2)
-        
-        # Publish the detected gesture
+                self.current_class_id = gesture_id
+                self.current_confidence = confidence
+        return frame, hand_landmarks
+
+    def annotate(self, frame, hand_landmarks, gesture):
+        """Draw landmarks and the recognized gesture onto frame"""
+        mp.solutions.drawing_utils.draw_landmarks(
+            frame, hand_landmarks, self.mp_hands.HAND_CONNECTIONS)
+        cv2.putText(frame, f"Gesture: {gesture}", (10, 50),
+                    cv2.FONT_HERSHEY_SIMPLEX, 1, (0, 255, 0), 2)
+
+    def publish_gesture(self, capture_stamp):
+        """Publish the current gesture for the frame captured at capture_stamp"""
+        gesture = Gesture()
+        gesture.header.stamp = capture_stamp
+        gesture.class_id = self.current_class_id
+        gesture.confidence = self.current_confidence
+        self.gesture_msg_publisher.publish(gesture)
+        for listener in self.listeners:
+            listener(gesture)
+
         msg = String()
         msg.data = self.current_gesture
         self.gesture_publisher.publish(msg)
-        self.get_logger().info(f'Publishing: {self.current_gesture}')
-        
-        # Display frame (optional)
+
+    def show_frame(self, frame):
+        """Show frame and shut down when 'q' is pressed"""
         cv2.imshow('Gesture Recognition', frame)
         if cv2.waitKey(1) & 0xFF == ord('q'):
             self.cleanup()
-            rclpy.shutdown()
+            self.shutdown()
+
+    def start_pipeline(self):
+        """Start the capture, recognition and display threads"""
+        self.running = threading.Event()
+        self.running.set()
+        self.frame_slot = LatestSlot()
+        self.display_slot = LatestSlot()
+
+        self.threads = [
+            threading.Thread(target=self.capture_loop, name='capture', daemon=True),
+            threading.Thread(target=self.recognition_loop, name='recognition',
+                             daemon=True),
+        ]
+        if self.display:
+            self.threads.append(
+                threading.Thread(target=self.display_loop, name='display', daemon=True))
+        for thread in self.threads:
+            thread.start()
+
+        self.get_logger().info(
+            f"Pipelined recognition started (camera {self.camera_fps:.0f} fps, "
+            f"display {'on' if self.display else 'off'})")
+
+    def capture_loop(self):
+        """Grab frames as fast as the camera delivers them"""
+        seq = 0
+        while self.running.is_set():
+            ret, image = self.cap.read()
+            if not ret:
+                self.get_logger().warn("Failed to capture frame", throttle_duration_sec=1.0)
+                time.sleep(0.01)
+                continue
+            frame = Frame(image, time.monotonic(), self.get_clock().now().to_msg(), seq)
+            if self.frame_slot.put(frame):
+                self.tracer.count('dropped')
+            self.tracer.count('captured')
+            seq += 1
+
+    def recognition_loop(self):
+        """Recognize and publish the newest captured frame"""
+        while self.running.is_set():
+            frame = self.frame_slot.take(timeout=0.5)
+            if frame is None:
+                continue
+            start = time.monotonic()
+            image, hand_landmarks = self.recognize(frame.image)
+            recognized = time.monotonic()
+            self.publish_gesture(frame.capture_stamp)
+            published = time.monotonic()
+            if self.recorder is not None:
+                self.record_frame(frame.capture_stamp, frame.seq, image, hand_landmarks)
+
+            self.tracer.record('queue', start - frame.stamp)
+            self.tracer.record('recognize', recognized - start)
+            self.tracer.record('publish', published - recognized)
+            self.tracer.record('capture_to_publish', published - frame.stamp)
+            self.tracer.count('processed')
+
+            if self.display:
+                self.display_slot.put((image, hand_landmarks, self.current_gesture))
+
+    def display_loop(self):
+        """Render the latest recognized frame outside the hot path"""
+        while self.running.is_set():
+            item = self.display_slot.take(timeout=0.5)
+            if item is None:
+                continue
+            image, hand_landmarks, gesture = item
+            if hand_landmarks is not None:
+                self.annotate(image, hand_landmarks, gesture)
+            cv2.imshow('Gesture Recognition', image)
+            if cv2.waitKey(1) & 0xFF == ord('q'):
+                self.running.clear()
+                self.shutdown()
+
+    def shutdown(self):
+        """Run the shutdown hooks, then shut rclpy down"""
+        for hook in self.shutdown_hooks:
+            hook()
+        rclpy.shutdown()
+
+    def command_callback(self, msg):
+        """Record a command stamped with the gesture that set its position"""
+        self.recorder.write_command(
+            stamp_to_ns(msg.header.stamp), (msg.twist.linear.x, msg.twist.angular.z))
+
+    def record_frame(self, capture_stamp, seq, image, hand_landmarks):
+        """Append the frame just published to the recording"""
+        landmarks = image_size = None
+        if hand_landmarks is not None:
+            landmarks = [(lm.x, lm.y, lm.z) for lm in hand_landmarks.landmark]
+            image_size = (image.shape[1], image.shape[0])
+        self.recorder.write_frame(
+            stamp_to_ns(capture_stamp), seq, self.current_class_id, self.current_confidence,
+            landmarks, image_size, self.current_features)
+
+    def stop_pipeline(self):
+        """Stop and join the pipeline threads"""
+        self.running.clear()
+        self.frame_slot.close()
+        self.display_slot.close()
+        for thread in self.threads:
+            if thread is not threading.current_thread():
+                thread.join(timeout=1.0)
     
     def calc_landmark_list(self, image, landmarks):
         """Convert normalized landmarks to pixel coordinates"""
-        image_width, image_height = image.shape[1], image.shape[0]
-        return [
-            [min(int(landmark.x * image_width), image_width - 1),
-
-             min(int(landmark.y * image_height), image_height - 1)]
-            for landmark in landmarks.landmark
-        ]
+        return calc_landmark_list(image.shape[1], image.shape[0], landmarks)
     
     def pre_process_landmark(self, landmark_list):
         """Convert to relative coordinates and normalize"""
-        # Relative to wrist (landmark 0)
-        base_x, base_y = landmark_list[0]
-        relative_landmarks = [[x - base_x, y - base_y] for x, y in landmark_list]
-        
-        # Flatten and normalize
-        flattened = list(itertools.chain.from_iterable(relative_landmarks))
-        max_val = max(abs(x) for x in flattened) or 1.0  # Avoid division by zero
-        return [x / max_val for x in flattened]
+        return pre_process_landmark(landmark_list)
     
     def run_model_inference(self, input_data):
-        """Run the TFLite model"""
+        """Run the keypoint classifier"""
+        if self.classifier_backend != 'tflite':
+            return self.classifier(input_data)
         input_data = np.array([input_data], dtype=np.float32)
         self.interpreter.set_tensor(self.input_details[0]['index'], input_data)
         self.interpreter.invoke()
         output_data = self.interpreter.get_tensor(self.output_details[0]['index'])
-        return np.argmax(output_data[0])
+        gesture_id = int(np.argmax(output_data[0]))
+        return gesture_id, float(output_data[0][gesture_id])
     
     def cleanup(self):
         """Release resources"""
+        if self.use_pipeline:
+            self.stop_pipeline()
         self.cap.release()
         cv2.destroyAllWindows()
+        self.tracer.close()
+        if self.recorder is not None:
+            self.recorder.close()
         self.get_logger().info("Cleaned up resources")
 
 def main(args=None):
@@ -146,6 +343,10 @@ def main(args=None):
     except KeyboardInterrupt:
         pass
     finally:
+        if node.use_pipeline:
+            node.cleanup()
+        elif node.recorder is not None:
+            node.recorder.close()
         # Only clean up if not already shutdown
         if rclpy.ok():
             node.destroy_node()
@@ -0,0 +1,56 @@
+#!/usr/bin/env python3
+
+"""Gesture recognition and the cmd_vel ramp composed in one process.
+
+Recognized gestures are handed to the ramp by a direct call instead of a
+round trip through the 'gesture' topic, and the ramp steps on every gesture
+rather than waiting for the next control tick.
+"""
+
+import rclpy
+from rclpy.executors import ExternalShutdownException, SingleThreadedExecutor
+from rclpy.parameter import Parameter
+
+from turtlebot3_nodes.turtlebot3_cmd_vel import CmdVelPublisher
+from turtlebot3_nodes.turtlebot3_gesture_publisher import GesturePublisher
+
+
+def main(args=None):
+    rclpy.init(args=args)
+    # Gestures arrive per processed frame, so always ramp on them
+    cmd_vel_publisher = CmdVelPublisher(
+        subscribe=False, parameter_overrides=[Parameter('event_driven', value=True)])
+    # Quitting with 'q' shuts rclpy down from the publisher, so the robot is
+    # stopped there while the context is still valid
+    gesture_publisher = GesturePublisher(listeners=[cmd_vel_publisher.listener_callback],
+                                         shutdown_hooks=[cmd_vel_publisher.stop])
+    if gesture_publisher.recorder is not None:
+        # Record every ramp step so replays can reproduce the commands
+        cmd_vel_publisher.listeners.append(gesture_publisher.recorder.on_command)
+
+    executor = SingleThreadedExecutor()
+    executor.add_node(gesture_publisher)
+    executor.add_node(cmd_vel_publisher)
+    try:
+        executor.spin()
+    except KeyboardInterrupt:
+        cmd_vel_publisher.get_logger().info("Shutting down...")
+    except ExternalShutdownException:
+        pass
+    finally:
+        if gesture_publisher.use_pipeline:
+            gesture_publisher.cleanup()
+        elif gesture_publisher.recorder is not None:
+            gesture_publisher.recorder.close()
+        # Stop the robot before shutting down
+        if rclpy.ok():
+            cmd_vel_publisher.stop()
+        executor.shutdown()
+        gesture_publisher.destroy_node()
+        cmd_vel_publisher.destroy_node()
+        if rclpy.ok():
+            rclpy.shutdown()
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,51 @@
+#!/usr/bin/env python3
+
+"""Velocity ramp and limits applied to gesture position commands."""
+
+# Default velocity limits and increments per control period
+LINEAR_VEL_LIMIT = 0.22  # m/s
+ANGULAR_VEL_LIMIT = 0.5  # rad/s
+LINEAR_VEL_INCREMENT = 0.05  # m/s
+ANGULAR_VEL_INCREMENT = 0.05  # rad/s
+CONTROL_PERIOD = 0.1  # s
+
+
+class VelocityRamp:
+    """Ramp linear/angular velocity toward the limit of a position command."""
+
+    def __init__(self, linear_limit=LINEAR_VEL_LIMIT, angular_limit=ANGULAR_VEL_LIMIT,
+                 linear_increment=LINEAR_VEL_INCREMENT,
+                 angular_increment=ANGULAR_VEL_INCREMENT, period=CONTROL_PERIOD):
+        self.linear_limit = linear_limit
+        self.angular_limit = angular_limit
+        self.linear_increment = linear_increment
+        self.angular_increment = angular_increment
+        self.period = period
+        self.linear_vel = 0.0
+        self.angular_vel = 0.0
+
+    def step(self, position, dt=None):
+        """Advance one control period, or dt seconds at the same acceleration.
+
+        Returns the new (linear, angular) velocity.
+        """
+        scale = 1.0 if dt is None else dt / self.period
+        linear_increment = self.linear_increment * scale
+        angular_increment = self.angular_increment * scale
+
+        if position == 'Forward':
+            self.linear_vel = min(self.linear_vel + linear_increment, self.linear_limit)
+            self.angular_vel = 0.0
+        elif position == 'Backward':
+            self.linear_vel = max(self.linear_vel - linear_increment, -self.linear_limit)
+            self.angular_vel = 0.0
+        elif position == 'Left':
+            self.angular_vel = min(self.angular_vel + angular_increment, self.angular_limit)
+            self.linear_vel = 0.0
+        elif position == 'Right':
+            self.angular_vel = max(self.angular_vel - angular_increment, -self.angular_limit)
+            self.linear_vel = 0.0
+        elif position == 'Stop':
+            self.linear_vel = 0.0
+            self.angular_vel = 0.0
+        return self.linear_vel, self.angular_vel